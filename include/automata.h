@@ -5,10 +5,17 @@
 #define AUTOMATA_H
 
 #include "stack.h"
+#include "simulationContext.h"
 #include "ste.h"
 #include "specialElement.h"
+#include "compiledAutomata.h"
+#include "elementGraph.h"
+#include "bitParallelEngine.h"
+#include "lazyDFAEngine.h"
+#include "prefilter.h"
 #include "ANMLParser.h"
 #include "MNRLAdapter.h"
+#include "binaryAutomataParser.h"
 #include "errors.h"
 #include "util.h"
 
@@ -21,13 +28,33 @@
 #include <deque>
 #include <set>
 #include <unordered_set>
+#include <memory>
 #include <vector>
 #include <list>
 #include <fstream>
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <mnrl.hpp>
 
+// Features a simulation loop is specialized for. Loops are instantiated
+//  for every combination; the first four also select single symbol steps.
+//  SIM_PREFETCH is only used by the interleaved loop and never selected by flags.
+enum SimulationFeature {
+    SIM_REPORT = 0x1,     // record reports
+    SIM_EOD = 0x2,        // track end of data for start-of-data and eod STEs
+    SIM_SPECELS = 0x4,    // special element simulation
+    SIM_DEBUG = 0x8,      // profiling or state dumping
+    SIM_PROGRESS = 0x10,  // print progress
+    SIM_SKIP_IDLE = 0x20, // skip idle input with the prefilter
+    SIM_PREFETCH = 0x40   // prefetch successor lists and enabled STEs for a later step
+};
+
+#define SIM_NUM_STEP_VARIANTS 16
+#define SIM_NUM_LOOP_VARIANTS 64
 
+// generateDFA() gives up beyond this many DFA states
+#define DFA_DEFAULT_MAX_STATES (1U << 20)
 
 class Automata {
 
@@ -40,7 +67,6 @@ private:
     bool quiet;
     bool report;
     bool dump_state;
-    bool end_of_data;
     uint32_t dump_state_cycle;
 
     // Main automata data structures
@@ -50,35 +76,24 @@ private:
     std::vector<Element*> orderedSpecialElements;
     std::unordered_map<std::string, SpecialElement*> specialElements;
     
-    // Functional element stacks
-    Stack<Element *> enabledSTEs;
-    Stack<STE*> activatedSTEs;
-    Stack<STE*> latchedSTEs;
-    std::queue<Element*> enabledSpecialElements;
-    std::queue<SpecialElement*> activatedSpecialElements;
-    std::vector<SpecialElement*> latchedSpecialElements;
+    // Compiled graph used by the simulation hot path; contexts share it, so
+    // it outlives a graph edit until no context refers to it anymore
+    std::shared_ptr<CompiledAutomata> compiled;
+    Prefilter *prefilter;
     std::vector<SpecialElement*> activateNoInputSpecialElements;
 
+    // Simulation state used when no context is given explicitly
+    SimulationContext context;
+
+    // Alternative simulation engines
+    BitParallelEngine *bitParallelEngine;
+    LazyDFAEngine *lazyDFAEngine;
+    uint64_t lazyDFACacheSize;
 
-    // Simulation Statistics
-    std::vector<std::pair<uint64_t, std::string>> reportVector;
-    std::unordered_map<uint32_t, std::list<std::string>> activationVector;
-    std::unordered_map<std::string, uint32_t> activationHist;    
-    std::vector<uint32_t> enabledHist;
-    std::vector<uint32_t> activatedHist;
-    uint32_t maxActivations;
-    std::unordered_map<Element*, uint32_t> enabledCount;
-    std::unordered_map<Element*, uint32_t> activatedCount;
-    std::queue<Element *> enabledLastCycle;
-    std::queue<Element *> activatedLastCycle;
-    std::queue<Element *> reportedLastCycle;
 
     // Misc
     vasim_err_t error;
     
-    //
-    uint64_t cycle;
-    
 public:
 
     // Constructors
@@ -87,6 +102,10 @@ public:
     Automata(std::string fn, std::string filetype);
     void parseAutomataFile(std::string fn, std::string filetype);
     void finalizeAutomata();
+    CompiledAutomata *compileAutomata();
+    CompiledAutomata *getCompiledAutomata();
+    void compileSpecialElementInputs();
+    void invalidateCompiledAutomata();
     
     // Get/set
     std::vector<STE *> &getStarts();
@@ -101,6 +120,11 @@ public:
     void setReport(bool);
     void setDumpState(bool, uint64_t);
     void setEndOfData(bool);
+    uint64_t getCycle();
+    void setLazyDFACacheSize(uint64_t);
+    LazyDFAEngine *getLazyDFAEngine();
+    SimulationContext &getSimulationContext();
+    SimulationContext *newSimulationContext();
     Element *getElement(std::string);
     void setErrorCode(vasim_err_t err);
     vasim_err_t getErrorCode();
@@ -110,44 +134,70 @@ public:
     // I/O
     void print();
     void writeReportToFile(std::string fn);
+    void writeReportToFile(SimulationContext &, std::string fn);
     void printReportBatchSim();
-    std::string activationHistogramToString();
+    void printReportBatchSim(SimulationContext &);
+    std::string activationHistogramToString(SimulationContext &);
     void automataToDotFile(std::string fn);
     void automataToNFAFile(std::string fn);
     void automataToANMLFile(std::string fn);
     void automataToMNRLFile(std::string fn);
+    void automataToBinaryFile(std::string fn);
     void automataToHDLFile(std::string fn);
     void automataToBLIFFile(std::string fn);
     void automataToGraphFile(std::string fn);
 
     // Simulation
     void initializeSimulation();
+    void initializeSimulation(bool enableStartOfData);
+    void initializeSimulation(SimulationContext &, bool enableStartOfData);
     void simulate(uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t end_index);
+    void simulate(SimulationContext &, uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t end_index);
+    void simulateChunk(uint8_t *inputs, uint64_t length, bool end_of_input);
+    void simulateChunk(SimulationContext &, uint8_t *inputs, uint64_t length, bool end_of_input);
+    void simulateInterleaved(SimulationContext **, uint8_t **inputs, uint64_t *lengths, bool *end_of_input, uint32_t num_streams);
+    void reconcileSlice(SimulationContext &, SimulationContext &previous, uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t end_index);
     void simulate(uint8_t);
+    void simulate(SimulationContext &, uint8_t);
     void simulate(uint8_t, std::vector<std::string> injects);
+    void simulateBitParallel(uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t end_index);
+    void simulateBitParallel(SimulationContext &, uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t end_index);
+    void simulateLazyDFA(uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t end_index);
+    void simulateLazyDFA(SimulationContext &, uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t end_index);
     void reset();
-    void enableStartStates(bool enableStartOfData); // formerly stageOne
-    void computeSTEMatches(uint8_t); // formerly stageTwo
-    void enableSTEMatchingChildren(); // formerly stageThree
-    void specialElementSimulation(); // formerly stageFour/Five
-    void specialElementSimulation2(); // formerly stageFour/Five
-    uint64_t tick();
+    uint32_t getSimulationFeatures();
+    template<uint32_t F> void simulateStep(SimulationContext &, uint8_t);
+    template<uint32_t F> void simulateLoop(SimulationContext &, uint8_t *inputs, uint64_t length, bool end_of_input);
+    template<uint32_t F, class Step> void runLoop(SimulationContext &, uint8_t *inputs, uint64_t length, bool end_of_input, Step step);
+    template<class Engine> void simulateEngine(Engine *, SimulationContext &, uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t end_index);
+    void finishProgress(uint64_t length);
+    template<uint32_t F> void simulateInterleavedLoop(SimulationContext **, uint8_t **inputs, uint64_t *lengths, bool *end_of_input, uint32_t num_streams);
+    template<uint32_t F> void enableStartStates(SimulationContext &, bool enableStartOfData); // formerly stageOne
+    template<uint32_t F> void computeSTEMatches(SimulationContext &, uint8_t); // formerly stageTwo
+    template<uint32_t F> void activateSTE(SimulationContext &, uint32_t, const CompiledSTE &);
+    template<uint32_t F> void enableSTEMatchingChildren(SimulationContext &); // formerly stageThree
+    void specialElementSimulation2(SimulationContext &); // formerly stageFour/Five
+    void enableSpecialElementChildSTEs(SimulationContext &, uint32_t specel_index);
+    void raiseGateInputs(SimulationContext &, const uint32_t *begin, const uint32_t *end);
+    void raiseSpecialElementPorts(SimulationContext &, const uint32_t *begin, const uint32_t *end);
+    void fireSpecialElement(SimulationContext &, uint32_t specel_index);
+    uint64_t tick(SimulationContext &);
 
 
     // Statistics and Profiling
-    void profileEnables();
-    void profileActivations();
+    void profileEnables(SimulationContext &);
+    void profileActivations(SimulationContext &);
     std::unordered_map<Element*, uint32_t> &getEnabledCount();
     std::unordered_map<Element*, uint32_t> &getActivatedCount();
     std::queue<Element *> &getEnabledLastCycle();
     std::queue<Element *> &getActivatedLastCycle();
     std::queue<Element *> &getReportedLastCycle();
-    void buildActivationHistogram(std::string fn);
-    void calcEnableDistribution();
+    void buildActivationHistogram(SimulationContext &, std::string fn);
+    void calcEnableDistribution(SimulationContext &);
     void printGraphStats();
     void printSTEComplexity();
-    void dumpSTEState(std::string fn);
-    void dumpSpecelState(std::string fn);
+    void dumpSTEState(SimulationContext &, std::string fn);
+    void dumpSpecelState(SimulationContext &, std::string fn);
 
     // Manipulation
     void addEdge(Element *from, Element *to);
@@ -180,12 +230,12 @@ public:
     uint32_t mergeCommonPrefixes();
     uint32_t mergeCommonSuffixes();
     uint32_t mergeCommonPaths();
-    Automata * generateDFA();
-    void eliminateDeadStates();
+    Automata * generateDFA(uint32_t max_states = DFA_DEFAULT_MAX_STATES);
+    uint32_t eliminateDeadStates();
     void removeRedundantEdges();
     
     // Util
-    std::set<STE*>* follow(uint32_t, std::set<STE*>*);
+    std::vector<STE*> orderSTEsBreadthFirst();
     std::string getElementColor(std::string);
     std::string getElementColorLog(std::string);
     std::string getLogElementColor(std::string);
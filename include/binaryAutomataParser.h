@@ -0,0 +1,118 @@
+/**
+ * @file
+ */
+#ifndef BINARY_AUTOMATA_PARSER_H
+#define BINARY_AUTOMATA_PARSER_H
+
+#include "ste.h"
+#include "and.h"
+#include "or.h"
+#include "nor.h"
+#include "counter.h"
+#include "inverter.h"
+#include "errors.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// binary automata file identification
+#define BINARY_AUTOMATA_MAGIC "VASIMBIN"
+#define BINARY_AUTOMATA_VERSION 1
+#define BINARY_AUTOMATA_BYTE_ORDER 0x01020304
+#define BINARY_AUTOMATA_EXTENSION "vab"
+
+// BinaryElement flag bits
+enum BinaryElementFlag {
+    BE_REPORTING = 0x1,
+    BE_EOD = 0x2,
+    BE_START_OF_DATA = 0x4,
+    BE_ALL_INPUT = 0x8,
+    BE_COUNTER_LATCH = 0x10,
+    BE_COUNTER_ROLL = 0x20
+};
+
+/*
+ * Byte range of a string in the string pool.
+ */
+struct BinaryString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+/*
+ * File header. All sections start at 8 byte aligned offsets and use the
+ *  byte order of the machine that wrote them.
+ */
+struct BinaryAutomataHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t num_elements;
+    uint32_t num_edges;
+    uint64_t elements_offset;
+    uint64_t edges_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    BinaryString id;
+    uint64_t file_size;
+};
+
+/*
+ * One element. Outgoing edges of element i are stored in
+ *  edges[edges_begin, edges_end); STE charsets are stored as a 256 bit
+ *  column so loading never parses a symbol set.
+ */
+struct BinaryElement {
+    uint64_t column[4];
+    uint32_t type;
+    uint32_t flags;
+    uint32_t target;
+    uint32_t edges_begin;
+    uint32_t edges_end;
+    BinaryString id;
+    BinaryString symbol_set;
+    BinaryString report_code;
+    uint32_t reserved;
+};
+
+/*
+ * Edge to element index "to", entering through port (e.g. ":cnt"), which
+ *  is empty for elements with a single input.
+ */
+struct BinaryEdge {
+    uint32_t to;
+    BinaryString port;
+};
+
+/*
+ * Loads automata written by Automata::automataToBinaryFile(). The file is
+ *  memory mapped and read in place: elements are created directly from
+ *  fixed-size records and wired by index, so neither XML, symbol sets nor
+ *  element ids are parsed and finalizeAutomata() is not needed.
+ */
+class BinaryAutomataParser {
+
+private:
+    std::string filename;
+
+    vasim_err_t parseImage(const uint8_t *image, uint64_t size,
+                           std::unordered_map<std::string, Element*>&,
+                           std::vector<STE*>&,
+                           std::vector<Element*>&,
+                           std::unordered_map<std::string, SpecialElement*>&,
+                           std::string *,
+                           std::vector<SpecialElement*>&);
+
+public:
+    BinaryAutomataParser(std::string);
+    vasim_err_t parse(std::unordered_map<std::string, Element*>&,
+                      std::vector<STE*>&,
+                      std::vector<Element*>&,
+                      std::unordered_map<std::string, SpecialElement*>&,
+                      std::string *,
+                      std::vector<SpecialElement*>&);
+};
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * @file
+ */
+#ifndef BIT_PARALLEL_ENGINE_H
+#define BIT_PARALLEL_ENGINE_H
+
+#include "compiledAutomata.h"
+#include "reportSink.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+/*
+ * Simulates STE-only automata using dense bit vectors indexed by STE.
+ *  Enabled and activated sets are stored one bit per STE and all
+ *  state transitions are computed with word-wide logical operations.
+ */
+class BitParallelEngine {
+
+private:
+    uint32_t num_stes;
+    uint32_t num_words;
+
+    // compiled graph; bit i corresponds to compiled STE i
+    CompiledAutomata *compiled;
+
+    // 256 masks of STEs that match each symbol (num_words each)
+    std::vector<uint64_t> match_table;
+
+    // start and report masks
+    std::vector<uint64_t> all_input_mask;
+    std::vector<uint64_t> start_of_data_mask;
+    std::vector<uint64_t> report_mask;
+    std::vector<uint64_t> eod_report_mask;
+
+    // successors of each STE stored as (word index, word mask) pairs
+    std::vector<uint32_t> succ_offsets;
+    std::vector<uint32_t> succ_words;
+    std::vector<uint64_t> succ_masks;
+
+    // simulation state
+    std::vector<uint64_t> enabled;
+    std::vector<uint64_t> activated;
+
+public:
+    BitParallelEngine(CompiledAutomata *compiled);
+
+    uint32_t getNumSTEs() { return num_stes; }
+
+    void enableStartStates(bool enableStartOfData);
+    void simulate(uint8_t symbol, bool end_of_data, uint64_t cycle,
+                  ReportSink *sink);
+    void reset();
+};
+
+#endif
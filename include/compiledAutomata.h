@@ -0,0 +1,122 @@
+/**
+ * @file
+ */
+#ifndef COMPILED_AUTOMATA_H
+#define COMPILED_AUTOMATA_H
+
+#include "ste.h"
+#include "specialElement.h"
+#include "gateNetwork.h"
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+// CompiledSTE flag bits
+enum CompiledSTEFlag {
+    CSTE_ALL_INPUT = 0x1,
+    CSTE_START_OF_DATA = 0x2,
+    CSTE_REPORTING = 0x4,
+    CSTE_EOD = 0x8,
+    CSTE_SPECEL_CHILDREN = 0x10,
+    CSTE_GATE_CHILDREN = 0x20
+};
+
+/*
+ * Flat STE record used by the simulation hot path. Successors of STE i
+ *  are stored in CompiledAutomata::successors[succ_begin, succ_end).
+ */
+struct CompiledSTE {
+
+    uint64_t column[4];
+    uint32_t flags;
+    uint32_t succ_begin;
+    uint32_t succ_end;
+
+    inline bool match(uint8_t symbol) const {
+        return (column[symbol >> 6] >> (symbol & 63)) & 1;
+    }
+};
+
+/*
+ * Read-only, index-based representation of an automata graph. STEs are
+ *  stored contiguously with their successor lists in a single CSR array,
+ *  so simulation never touches Element objects, strings or maps.
+ *  Element pointers are kept on the side for reporting and profiling.
+ *  Compiled ids number all elements: STE i has id i and special element
+ *  i has id getNumSTEs() + i.
+ */
+class CompiledAutomata {
+
+private:
+    // STE records and CSR successor array
+    std::vector<CompiledSTE> stes;
+    std::vector<uint32_t> successors;
+    std::vector<uint32_t> starts;
+
+    // per-symbol dispatch of all-input starts that match that symbol
+    std::vector<uint32_t> start_dispatch_offsets;
+    std::vector<uint32_t> start_dispatch;
+    std::vector<uint32_t> start_of_data_starts;
+
+    // true if any STE depends on end of data
+    bool uses_eod;
+
+    // special elements in evaluation order and their STE successors
+    std::vector<SpecialElement *> specels;
+    std::vector<uint32_t> specel_succ_offsets;
+    std::vector<uint32_t> specel_successors;
+
+    // gates among the special elements
+    GateNetwork *gates;
+
+    // cold data: index -> Element and Element -> index
+    std::vector<STE *> ste_elements;
+    std::unordered_map<Element *, uint32_t> index;
+
+    // compiled id -> element id and report code of reporting elements
+    std::vector<std::string> report_ids;
+    std::vector<std::string> report_codes;
+
+public:
+    CompiledAutomata(std::vector<STE *> &ordered_stes,
+                     std::vector<SpecialElement *> &ordered_specels);
+    ~CompiledAutomata();
+
+    inline uint32_t getNumSTEs() const { return stes.size(); }
+    inline const CompiledSTE &getSTE(uint32_t i) const { return stes[i]; }
+    inline const uint32_t *getSuccessors() const { return successors.data(); }
+    inline const std::vector<uint32_t> &getStarts() const { return starts; }
+    inline STE *getSTEElement(uint32_t i) const { return ste_elements[i]; }
+    inline const std::vector<uint32_t> &getStartOfDataStarts() const { return start_of_data_starts; }
+    inline bool usesEndOfData() const { return uses_eod; }
+    inline const uint32_t *getAllInputStartsBegin(uint8_t symbol) const {
+        return start_dispatch.data() + start_dispatch_offsets[symbol];
+    }
+    inline const uint32_t *getAllInputStartsEnd(uint8_t symbol) const {
+        return start_dispatch.data() + start_dispatch_offsets[symbol + 1];
+    }
+
+    inline uint32_t getNumSpecialElements() const { return specels.size(); }
+    inline SpecialElement *getSpecialElement(uint32_t i) const { return specels[i]; }
+    inline const uint32_t *getSpecialElementSuccessorsBegin(uint32_t i) const {
+        return specel_successors.data() + specel_succ_offsets[i];
+    }
+    inline const uint32_t *getSpecialElementSuccessorsEnd(uint32_t i) const {
+        return specel_successors.data() + specel_succ_offsets[i + 1];
+    }
+
+    inline const GateNetwork *getGateNetwork() const { return gates; }
+
+    inline uint32_t getNumElements() const { return stes.size() + specels.size(); }
+    inline uint32_t getSpecialElementId(uint32_t i) const { return stes.size() + i; }
+    inline Element *getElement(uint32_t id) const {
+        return (id < stes.size()) ? (Element *)ste_elements[id] : (Element *)specels[id - stes.size()];
+    }
+    inline const std::string &getReportId(uint32_t id) const { return report_ids[id]; }
+    inline const std::string &getReportCode(uint32_t id) const { return report_codes[id]; }
+
+    bool getIndex(Element *, uint32_t *);
+};
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * @file
+ */
+#ifndef COMPONENT_PARTITIONER_H
+#define COMPONENT_PARTITIONER_H
+
+#include "element.h"
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+class Automata;
+
+// fixed cost of an element per symbol, for the memory it occupies
+#define PARTITION_ELEMENT_COST 0.01
+
+// -T auto uses the fewest threads whose estimated makespan is this close to the best
+#define PARTITION_AUTO_TOLERANCE 1.05
+
+/*
+ * Distributes connected components among threads. The cost of a
+ *  component is an estimate of its work per input symbol: how often its
+ *  elements are enabled plus how often they activate, weighted by their
+ *  fan-out. Without profile data, enable and activation rates are
+ *  propagated from the start states assuming uniformly distributed
+ *  input, so a start state matches with probability breadth / 256 of
+ *  its charset. With profile data from a sample of the input, rates are
+ *  the counts recorded for each element divided by the sample length.
+ *  Components are assigned by longest-processing-time bin packing: in
+ *  order of decreasing cost, each goes to the least loaded thread.
+ */
+class ComponentPartitioner {
+
+private:
+    std::vector<double> costs;
+
+    double estimateCost(Automata *component);
+    double profiledCost(Automata *component,
+                        std::unordered_map<Element*, uint32_t> &enabledCount,
+                        std::unordered_map<Element*, uint32_t> &activatedCount,
+                        uint64_t cycles);
+    double makespan(uint32_t num_threads);
+
+public:
+    ComponentPartitioner(std::vector<Automata *> &components);
+    ComponentPartitioner(std::vector<Automata *> &components,
+                         std::unordered_map<Element*, uint32_t> &enabledCount,
+                         std::unordered_map<Element*, uint32_t> &activatedCount,
+                         uint64_t cycles);
+
+    std::vector<uint32_t> partition(uint32_t num_threads);
+    uint32_t chooseNumThreads(uint32_t max_threads);
+
+    inline double getCost(uint32_t component) { return costs[component]; }
+};
+
+#endif
@@ -14,10 +14,7 @@ class Counter : public SpecialElement {
 
 protected:
     uint32_t target;
-    uint32_t value;
     Mode mode;
-    bool dormant;
-    bool latched;
 
 public:
     Counter(std::string, uint32_t, std::string);
@@ -25,12 +22,11 @@ public:
 
     virtual ElementType getType();
 
-    virtual bool calculate();
+    virtual bool calculate(SpecialElementState &);
     void setMode(std::string);
+    std::string getMode();
     void setTarget(uint32_t);
     uint32_t getTarget();
-    uint32_t getValue();
-    virtual bool deactivate();
     virtual std::string toString();
     virtual std::string toANML();
     virtual MNRL::MNRLNode& toMNRLObj();
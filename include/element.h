@@ -27,9 +27,19 @@ enum ElementType {
     COUNTER_T
 };
 
+// input port an edge enters through; only counters have named ports
+enum ElementPort {
+    PORT_NONE,
+    PORT_CNT,
+    PORT_RST
+};
+
 class Element {
 
 protected:
+    // TODO:: edges are stored by string id and resolved through
+    //   Automata::getElement() when the graph is edited; ElementGraph only
+    //   gives analysis passes a read-only integer view of them
     std::vector<std::string> outputs;
     std::vector<std::pair<Element *, std::string>> outputSTEPointers;
     std::vector<std::pair<Element *, std::string>> outputSpecelPointers;
@@ -55,7 +65,7 @@ public:
     
     bool setId(std::string);
     bool setIntId(uint32_t);
-    inline std::string getId() {return id; }
+    inline const std::string &getId() {return id; }
     inline uint32_t getIntId() {return int_id; }
     bool setReporting(bool);
     bool isReporting();
@@ -71,14 +81,14 @@ public:
     void setEod(bool isEod);
     virtual bool isSpecialElement() = 0;
     virtual bool canActivateNoEnable();
-    std::vector<std::string> getOutputs();
-    std::vector<std::pair<Element *, std::string>> getOutputSTEPointers();
+    const std::vector<std::string> &getOutputs();
+    const std::vector<std::pair<Element *, std::string>> &getOutputSTEPointers();
     //std::vector<Element *> getOutputSTEPointers();
-    std::vector<std::pair<Element *, std::string>> getOutputSpecelPointers();
+    const std::vector<std::pair<Element *, std::string>> &getOutputSpecelPointers();
     bool clearOutputs();
     bool clearOutputPointers();
     bool clearInputs();
-    std::map<std::string, bool> getInputs();
+    const std::map<std::string, bool> &getInputs();
     bool addOutput(std::string);
     bool addOutputPointer(std::pair<Element *, std::string>);
     bool addOutputExisting(std::string, std::map<std::string,Element*>);
@@ -90,6 +100,8 @@ public:
     bool removeInput(std::string);
     static std::string stripPort(std::string);
     static std::string getPort(std::string);
+    static ElementPort portFromString(const std::string &);
+    static std::string portToString(ElementPort);
     virtual std::string toString() = 0;
     virtual std::string toANML() = 0;
     virtual MNRL::MNRLNode& toMNRLObj() = 0;
@@ -103,6 +115,8 @@ public:
     bool isSelfRef();
     bool identicalOutputs(Element *);
     bool identicalInputs(Element *);
+    uint64_t outputSignature();
+    uint64_t inputSignature();
     
     // backport additions
     bool isCut();
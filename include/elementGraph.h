@@ -0,0 +1,61 @@
+/**
+ * @file
+ */
+#ifndef ELEMENT_GRAPH_H
+#define ELEMENT_GRAPH_H
+
+#include "element.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/*
+ * Edge to the element with dense id "node", entering through "port".
+ */
+struct GraphEdge {
+    uint32_t node;
+    ElementPort port;
+};
+
+/*
+ * Integer view of an automata graph for analysis passes. Every element
+ *  gets a dense id in [0, size()), kept in the graph so the elements
+ *  themselves are not modified, and successors and predecessors are
+ *  stored as CSR arrays built from the Element output pointers in
+ *  O(V+E), without hashing or comparing any string ids. Predecessors of
+ *  a node are ordered by ascending id. The view is a read-only snapshot
+ *  for analysis passes: it is invalidated by any graph modification.
+ *  Elements still store their edges by string id, and passes that edit
+ *  the graph (removeEdge, removeElement and the merge passes) resolve
+ *  them through Automata::getElement().
+ */
+class ElementGraph {
+
+private:
+    // dense id <-> element
+    std::vector<Element *> nodes;
+    std::unordered_map<Element *, uint32_t> ids;
+
+    // CSR successor and predecessor arrays
+    std::vector<uint32_t> succ_offsets;
+    std::vector<GraphEdge> succ;
+    std::vector<uint32_t> pred_offsets;
+    std::vector<GraphEdge> pred;
+
+public:
+    ElementGraph(std::unordered_map<std::string, Element *> &elements);
+
+    inline uint32_t size() const { return nodes.size(); }
+    inline uint32_t getNumEdges() const { return succ.size(); }
+    inline Element *getElement(uint32_t i) const { return nodes[i]; }
+    inline uint32_t getId(Element *el) const { return ids.at(el); }
+
+    inline const GraphEdge *succBegin(uint32_t i) const { return succ.data() + succ_offsets[i]; }
+    inline const GraphEdge *succEnd(uint32_t i) const { return succ.data() + succ_offsets[i + 1]; }
+    inline const GraphEdge *predBegin(uint32_t i) const { return pred.data() + pred_offsets[i]; }
+    inline const GraphEdge *predEnd(uint32_t i) const { return pred.data() + pred_offsets[i + 1]; }
+};
+
+#endif
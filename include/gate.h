@@ -19,7 +19,7 @@ public:
 
     Gate(std::string id);
     virtual ~Gate();
-    virtual bool calculate() = 0;
+    virtual bool calculate(SpecialElementState &) = 0;
     bool isGate();
    
     virtual std::string toString() = 0;
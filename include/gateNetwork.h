@@ -0,0 +1,143 @@
+/**
+ * @file
+ */
+#ifndef GATE_NETWORK_H
+#define GATE_NETWORK_H
+
+#include "ste.h"
+#include "specialElement.h"
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+// gate or special element index that does not exist
+#define GATE_NONE 0xFFFFFFFF
+
+/*
+ * Levelized netlist of the AND, OR, NOR and Inverter gates of a compiled
+ *  automata. Every special element is placed one level above its highest
+ *  special element parent, so a level only depends on lower levels. Gates
+ *  are numbered level by level and every level is padded to whole 64 bit
+ *  words; bit b of word w is gate 64 * w + b. A word of gates is
+ *  evaluated at once from per-word gate type masks and two words of input
+ *  state, "some input is high" and "all inputs are high", so there is no
+ *  virtual calculate() per gate. Gate inputs are numbered globally and
+ *  STEs and special elements raise them by index. Special elements that
+ *  are not gates (counters) are listed per level and evaluated one by one;
+ *  their inputs are raised as port targets, a special element index and
+ *  the port it is raised on. Special elements are referenced by their
+ *  CompiledAutomata index.
+ */
+class GateNetwork {
+
+private:
+    uint32_t num_gates;
+    uint32_t num_inputs;
+
+    // per level: range of gate words and the other special elements
+    std::vector<uint32_t> level_words;
+    std::vector<uint32_t> level_others_offsets;
+    std::vector<uint32_t> level_others;
+
+    // per word: gate type masks and output while no input is high
+    std::vector<uint64_t> and_mask;
+    std::vector<uint64_t> or_mask;
+    std::vector<uint64_t> nor_mask;
+    std::vector<uint64_t> inv_mask;
+    std::vector<uint64_t> idle;
+
+    // per gate: special element index and number of inputs
+    std::vector<uint32_t> gate_specel;
+    std::vector<uint32_t> gate_num_inputs;
+
+    // per input: gate it belongs to
+    std::vector<uint32_t> input_gate;
+
+    // per special element: gate index
+    std::vector<uint32_t> specel_gate;
+
+    // gate inputs raised by each STE and by each special element (CSR)
+    std::vector<uint32_t> ste_target_offsets;
+    std::vector<uint32_t> ste_targets;
+    std::vector<uint32_t> specel_target_offsets;
+    std::vector<uint32_t> specel_targets;
+
+    // ports of other special elements raised by each STE and by each special element (CSR)
+    std::vector<uint32_t> ste_port_target_offsets;
+    std::vector<uint32_t> ste_port_targets;
+    std::vector<uint32_t> specel_port_target_offsets;
+    std::vector<uint32_t> specel_port_targets;
+
+public:
+    GateNetwork(std::vector<STE *> &stes,
+                std::vector<SpecialElement *> &specels,
+                std::unordered_map<Element *, uint32_t> &index);
+
+    static bool isGateType(ElementType type);
+
+    inline uint32_t getNumGates() const { return num_gates; }
+    inline uint32_t getNumInputs() const { return num_inputs; }
+    inline uint32_t getNumWords() const { return and_mask.size(); }
+    inline uint32_t getNumLevels() const { return level_words.size() - 1; }
+
+    inline uint32_t getLevelWordsBegin(uint32_t level) const { return level_words[level]; }
+    inline uint32_t getLevelWordsEnd(uint32_t level) const { return level_words[level + 1]; }
+    inline const uint32_t *getLevelOthersBegin(uint32_t level) const {
+        return level_others.data() + level_others_offsets[level];
+    }
+    inline const uint32_t *getLevelOthersEnd(uint32_t level) const {
+        return level_others.data() + level_others_offsets[level + 1];
+    }
+
+    /*
+     * Outputs of the 64 gates of word w given which of them have some and
+     *  all of their inputs high.
+     */
+    inline uint64_t evaluate(uint32_t w, uint64_t any, uint64_t all) const {
+        if(any == 0)
+            return idle[w];
+
+        return (and_mask[w] & all) |
+            (or_mask[w] & any) |
+            (nor_mask[w] & ~any) |
+            (inv_mask[w] & ~all);
+    }
+
+    inline uint32_t getSpecialElementIndex(uint32_t gate) const { return gate_specel[gate]; }
+    inline uint32_t getNumGateInputs(uint32_t gate) const { return gate_num_inputs[gate]; }
+    inline uint32_t getInputGate(uint32_t input) const { return input_gate[input]; }
+
+    inline uint32_t getGate(uint32_t specel) const { return specel_gate[specel]; }
+
+    static inline uint32_t portTarget(uint32_t specel, ElementPort port) { return (specel << 2) | port; }
+    static inline uint32_t getPortTargetSpecialElement(uint32_t target) { return target >> 2; }
+    static inline ElementPort getPortTargetPort(uint32_t target) { return (ElementPort)(target & 3); }
+
+    inline const uint32_t *getSTETargetsBegin(uint32_t ste) const {
+        return ste_targets.data() + ste_target_offsets[ste];
+    }
+    inline const uint32_t *getSTETargetsEnd(uint32_t ste) const {
+        return ste_targets.data() + ste_target_offsets[ste + 1];
+    }
+    inline const uint32_t *getSpecialElementTargetsBegin(uint32_t specel) const {
+        return specel_targets.data() + specel_target_offsets[specel];
+    }
+    inline const uint32_t *getSpecialElementTargetsEnd(uint32_t specel) const {
+        return specel_targets.data() + specel_target_offsets[specel + 1];
+    }
+    inline const uint32_t *getSTEPortTargetsBegin(uint32_t ste) const {
+        return ste_port_targets.data() + ste_port_target_offsets[ste];
+    }
+    inline const uint32_t *getSTEPortTargetsEnd(uint32_t ste) const {
+        return ste_port_targets.data() + ste_port_target_offsets[ste + 1];
+    }
+    inline const uint32_t *getSpecialElementPortTargetsBegin(uint32_t specel) const {
+        return specel_port_targets.data() + specel_port_target_offsets[specel];
+    }
+    inline const uint32_t *getSpecialElementPortTargetsEnd(uint32_t specel) const {
+        return specel_port_targets.data() + specel_port_target_offsets[specel + 1];
+    }
+};
+
+#endif
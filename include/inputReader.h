@@ -0,0 +1,44 @@
+/**
+ * @file
+ */
+#ifndef INPUT_READER_H
+#define INPUT_READER_H
+
+#include <stdint.h>
+#include <string>
+
+// default streaming chunk size (bytes)
+#define INPUT_READER_DEFAULT_CHUNK_SIZE (1ULL << 20)
+
+/*
+ * Reads an input stream in fixed-size chunks so that simulation can start
+ *  before the input has been read completely and memory use does not grow
+ *  with input size. Reads from a file, or from stdin if the file name is
+ *  "-". Regular files may optionally be memory mapped, in which case chunks
+ *  point directly into the mapping.
+ */
+class InputReader {
+
+private:
+    int fd;
+    uint64_t chunk_size;
+    uint64_t bytes_read;
+
+    // two buffers, so the previous chunk stays valid while the next is read
+    uint8_t *buffers[2];
+    uint32_t next_buffer;
+
+    // memory mapped input
+    uint8_t *map;
+    uint64_t map_size;
+
+public:
+    InputReader(std::string fn, uint64_t chunk_size, bool use_mmap);
+    ~InputReader();
+
+    uint64_t read(uint8_t **chunk);
+    uint64_t getBytesRead() { return bytes_read; }
+    bool isMapped() { return map != NULL; }
+};
+
+#endif
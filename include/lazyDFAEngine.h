@@ -0,0 +1,111 @@
+/**
+ * @file
+ */
+#ifndef LAZY_DFA_ENGINE_H
+#define LAZY_DFA_ENGINE_H
+
+#include "compiledAutomata.h"
+#include "reportSink.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+// default memory budget of the lazy DFA transition cache (bytes)
+#define LAZY_DFA_DEFAULT_CACHE_SIZE (64ULL * 1024 * 1024)
+
+/*
+ * Hashes a sorted set of compiled STE indices.
+ */
+struct STESetHash {
+    size_t operator()(const std::vector<uint32_t> &set) const {
+        uint64_t h = 14695981039346656037ULL;
+        for(uint32_t i : set) {
+            h ^= i;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+};
+
+/*
+ * Simulates STE-only automata as a DFA that is built on the fly. Each DFA
+ *  state is a hash-consed set of enabled STEs. Transitions and the reports
+ *  they emit are computed from the compiled NFA the first time a (state,
+ *  symbol) pair is seen and then cached, so a warm cache runs one table
+ *  lookup per symbol. The cache is flushed when it exceeds its memory
+ *  budget; if flushes happen faster than the cache pays off, the engine
+ *  stops caching and keeps stepping the NFA.
+ */
+class LazyDFAEngine {
+
+private:
+    // cached transition; next < 0 if not yet computed
+    struct Transition {
+        int32_t next;
+        uint32_t reports_begin;
+        uint32_t reports_end;
+    };
+
+    struct DFAState {
+        const std::vector<uint32_t> *set;
+        Transition transitions[256];
+    };
+
+    CompiledAutomata *compiled;
+
+    // hash-consed state table and reporting STEs of each transition
+    std::unordered_map<std::vector<uint32_t>, uint32_t, STESetHash> state_ids;
+    std::vector<DFAState *> states;
+    std::vector<uint32_t> report_pool;
+
+    // memory accounting
+    uint64_t max_memory;
+    uint64_t memory;
+
+    // simulation state
+    int32_t current;
+    std::vector<uint32_t> current_set;
+    bool caching;
+
+    // scratch space for NFA steps
+    std::vector<uint8_t> mark;
+    std::vector<uint32_t> activated;
+    std::vector<uint32_t> next_set;
+    std::vector<uint32_t> step_reports;
+
+    // statistics
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t flushes;
+    uint64_t states_created;
+    uint64_t symbols_since_flush;
+
+    uint32_t internState(std::vector<uint32_t> &set);
+    void flush();
+    void step(const std::vector<uint32_t> &enabled, uint8_t symbol, bool end_of_data);
+    void emitReports(const uint32_t *begin, const uint32_t *end, uint64_t cycle,
+                     ReportSink *sink);
+
+public:
+    LazyDFAEngine(CompiledAutomata *compiled, uint64_t max_memory);
+    ~LazyDFAEngine();
+
+    void enableStartStates(bool enableStartOfData);
+    void simulate(uint8_t symbol, bool end_of_data, uint64_t cycle,
+                  ReportSink *sink);
+    void reset();
+
+    uint64_t getHits() { return hits; }
+    uint64_t getMisses() { return misses; }
+    uint64_t getFlushes() { return flushes; }
+    uint64_t getStatesCreated() { return states_created; }
+    uint64_t getNumStates() { return states.size(); }
+    uint64_t getMemory() { return memory; }
+    bool isCaching() { return caching; }
+    void printStatistics();
+};
+
+#endif
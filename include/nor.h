@@ -18,7 +18,7 @@ public:
 
     virtual ElementType getType();
 
-    virtual bool calculate();
+    virtual bool calculate(SpecialElementState &);
     virtual std::string toString();
     virtual std::string toANML();
     virtual MNRL::MNRLNode& toMNRLObj();
@@ -0,0 +1,34 @@
+/**
+ * @file
+ */
+#ifndef PREFILTER_H
+#define PREFILTER_H
+
+#include "compiledAutomata.h"
+
+#include <stdint.h>
+
+/*
+ * Finds input offsets where simulation of an idle automata can make
+ *  progress. While no STE is enabled, only a symbol matched by an
+ *  all-input start STE can activate anything, and only an end-of-data
+ *  symbol can re-enable start-of-data STEs. Every other symbol can be
+ *  skipped without changing reports.
+ */
+class Prefilter {
+
+private:
+    // symbols that stop a scan
+    uint8_t stop[256];
+    uint32_t num_stop_symbols;
+    uint8_t first_stop_symbol;
+
+public:
+    Prefilter(CompiledAutomata *compiled);
+
+    // true if at least one symbol can be skipped
+    inline bool canSkip() const { return num_stop_symbols < 256; }
+    uint64_t scan(const uint8_t *inputs, uint64_t start, uint64_t end) const;
+};
+
+#endif
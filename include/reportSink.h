@@ -0,0 +1,124 @@
+/**
+ * @file
+ */
+#ifndef REPORT_SINK_H
+#define REPORT_SINK_H
+
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+#include <functional>
+
+// simulation loops tell their sink how far they got at least every this many symbols
+#define REPORT_SINK_ADVANCE_INTERVAL 4096
+
+/*
+ * A report: the cycle and the compiled id of the reporting element.
+ *  Compiled ids number STEs by their CompiledAutomata index, followed by
+ *  special elements; CompiledAutomata resolves them to element ids and
+ *  report codes through precomputed tables.
+ */
+struct Report {
+    uint64_t cycle;
+    uint32_t element;
+
+    inline bool operator<(const Report &other) const {
+        return cycle < other.cycle || (cycle == other.cycle && element < other.element);
+    }
+    inline bool operator==(const Report &other) const {
+        return cycle == other.cycle && element == other.element;
+    }
+};
+
+/*
+ * Receives the reports of a simulation in the order they are produced,
+ *  on the thread that runs the simulation. Simulation also calls
+ *  advance(cycle) from time to time to promise that all reports before
+ *  cycle have been sent.
+ */
+class ReportSink {
+
+public:
+    virtual ~ReportSink();
+    virtual void report(uint64_t cycle, uint32_t element) = 0;
+    virtual void advance(uint64_t cycle);
+};
+
+/*
+ * Keeps all reports in memory. Default sink of every SimulationContext.
+ */
+class ReportVectorSink : public ReportSink {
+
+private:
+    std::vector<Report> reports;
+
+public:
+    virtual void report(uint64_t cycle, uint32_t element);
+
+    inline std::vector<Report> &getReports() { return reports; }
+    inline void clear() { reports.clear(); }
+};
+
+/*
+ * Hands every report to a function.
+ */
+class CallbackReportSink : public ReportSink {
+
+private:
+    std::function<void(uint64_t, uint32_t)> callback;
+
+public:
+    CallbackReportSink(std::function<void(uint64_t, uint32_t)> callback);
+    virtual void report(uint64_t cycle, uint32_t element);
+};
+
+/*
+ * Only counts reports and the cycles that reported.
+ */
+class CountingReportSink : public ReportSink {
+
+private:
+    uint64_t num_reports;
+    uint64_t num_cycles;
+    uint64_t last_cycle;
+
+public:
+    CountingReportSink();
+    virtual void report(uint64_t cycle, uint32_t element);
+
+    inline uint64_t getNumReports() { return num_reports; }
+    inline uint64_t getNumReportingCycles() { return num_cycles; }
+    void clear();
+};
+
+/*
+ * Lock-free single producer, single consumer ring buffer of reports.
+ *  The simulation thread produces and waits while the buffer is full,
+ *  so memory stays bounded by the capacity no matter how many reports a
+ *  run produces; another thread consumes with peek() and pop(). The
+ *  watermark published by advance() lets the consumer tell an idle
+ *  producer from one that may still report an earlier cycle.
+ */
+class RingBufferReportSink : public ReportSink {
+
+private:
+    std::vector<Report> buffer;
+    uint64_t mask;
+
+    // head is only written by the consumer and tail by the producer
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+    std::atomic<uint64_t> watermark;
+
+public:
+    RingBufferReportSink(uint64_t capacity);
+    virtual void report(uint64_t cycle, uint32_t element);
+    virtual void advance(uint64_t cycle);
+
+    bool peek(Report &r);
+    bool pop(Report &r);
+    inline uint64_t getWatermark() { return watermark.load(std::memory_order_acquire); }
+    inline uint64_t getCapacity() { return buffer.size(); }
+};
+
+#endif
@@ -0,0 +1,139 @@
+/**
+ * @file
+ */
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include "compiledAutomata.h"
+#include "reportSink.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+// default number of reports buffered between a simulation thread and the writer
+#define REPORT_WRITER_DEFAULT_RING_SIZE (1ULL << 16)
+
+// default number of bytes buffered per report file before it is written
+#define REPORT_WRITER_DEFAULT_BUFFER_SIZE (1ULL << 20)
+
+// binary report file identification
+#define BINARY_REPORT_MAGIC "VASIMREP"
+#define BINARY_REPORT_VERSION 1
+#define BINARY_REPORT_BYTE_ORDER 0x01020304
+#define BINARY_REPORT_EXTENSION "vrb"
+
+// size of one report record in a binary report file
+#define BINARY_REPORT_RECORD_SIZE 12
+
+enum ReportFormat {
+    REPORT_FORMAT_TEXT,
+    REPORT_FORMAT_BINARY
+};
+
+/*
+ * Binary report file header. The header is followed by num_elements
+ *  BinaryReportElement entries (the compiled ids of every stream of the
+ *  file, stream after stream), the string pool and, from records_offset
+ *  to the end of the file, one record per report: the cycle (8 bytes)
+ *  followed by the index of the element in the table (4 bytes). All
+ *  values use the byte order of the machine that wrote them.
+ */
+struct BinaryReportHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t num_elements;
+    uint32_t reserved;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    uint64_t records_offset;
+};
+
+/*
+ * Element id and report code of a compiled id, as byte ranges of the
+ *  string pool. Both are empty for elements that do not report.
+ */
+struct BinaryReportElement {
+    uint32_t id_offset;
+    uint32_t id_length;
+    uint32_t report_code_offset;
+    uint32_t report_code_length;
+};
+
+/*
+ * Writes reports to files on a dedicated thread while simulation runs.
+ *  Every stream is fed by one simulation thread through a bounded ring
+ *  buffer; the writer drains all rings in the background and writes
+ *  each output file in large batches. A simulation thread waits when its
+ *  ring is full, so memory stays bounded no matter how many reports a
+ *  run produces.
+ *
+ *  An output may be fed by several streams, which are then merged into
+ *  a single report stream ordered by cycle, and by stream order within a
+ *  cycle. A report is only written once the watermarks of all idle
+ *  streams of its output show that none of them can still report an
+ *  earlier cycle. Streams and outputs must be added before start().
+ */
+class ReportWriter {
+
+private:
+    struct Stream {
+        RingBufferReportSink sink;
+        const CompiledAutomata *compiled;
+
+        // first id of this stream in the element table of its output
+        uint32_t base;
+
+        Stream(uint64_t ring_size) : sink(ring_size) {}
+    };
+
+    struct Output {
+        std::vector<Stream *> streams;
+        int fd;
+        std::string buffer;
+
+        // statistics
+        uint64_t num_reports;
+        uint64_t num_cycles;
+        uint64_t last_cycle;
+    };
+
+    ReportFormat format;
+    uint64_t ring_size;
+    uint64_t buffer_size;
+
+    std::vector<Output *> outputs;
+    std::vector<Stream *> streams;
+    std::thread writer;
+    std::atomic<bool> done;
+    bool running;
+
+    void run();
+    uint64_t drain(Output *o, bool last);
+    void append(Output *o, Stream *s, const Report &r);
+    void appendText(Output *o, Stream *s, const Report &r);
+    void appendBinary(Output *o, Stream *s, const Report &r);
+    void appendBinaryHeader(Output *o);
+    void flush(Output *o);
+
+public:
+    ReportWriter(ReportFormat format);
+    ReportWriter(ReportFormat format, uint64_t ring_size, uint64_t buffer_size);
+    ~ReportWriter();
+
+    uint32_t addOutput(std::string fn);
+    ReportSink *addStream(uint32_t output, const CompiledAutomata *compiled);
+    ReportSink *addStream(std::string fn, const CompiledAutomata *compiled);
+    void start();
+    void finish();
+
+    inline uint32_t getNumOutputs() { return outputs.size(); }
+    inline uint32_t getNumStreams() { return streams.size(); }
+    inline uint64_t getNumReports(uint32_t output) { return outputs[output]->num_reports; }
+    inline uint64_t getNumReportingCycles(uint32_t output) { return outputs[output]->num_cycles; }
+};
+
+#endif
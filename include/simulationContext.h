@@ -0,0 +1,115 @@
+/**
+ * @file
+ */
+#ifndef SIMULATION_CONTEXT_H
+#define SIMULATION_CONTEXT_H
+
+#include "stack.h"
+#include "element.h"
+#include "specialElement.h"
+#include "compiledAutomata.h"
+#include "reportSink.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <queue>
+#include <utility>
+#include <unordered_map>
+#include <memory>
+
+/*
+ * Per-run simulation state of one input stream. The automata graph and
+ *  its CompiledAutomata are read-only during simulation, so any number of
+ *  contexts can be simulated against the same Automata, one per thread.
+ *  STEs are referenced by compiled index; the enabled flags are cleared
+ *  by draining the enabled stack, so a reset costs O(enabled STEs).
+ *  Gate inputs raised during a cycle and the state of every special
+ *  element, by compiled special element index, are kept here as well.
+ *  Reports go to a ReportSink as (cycle, compiled id) pairs; by default
+ *  they are collected in the context. The context shares ownership of its
+ *  compiled graph, so collected reports can still be resolved after the
+ *  automata was edited and recompiled.
+ */
+class SimulationContext {
+
+    friend class Automata;
+
+private:
+    // Functional element stacks (STEs are referenced by compiled index)
+    Stack<uint32_t> enabledSTEs;
+    Stack<uint32_t> activatedSTEs;
+    // size of enabledSTEs once the start states were enabled
+    uint32_t startStatesTop;
+    std::vector<uint8_t> steEnabled;
+
+    // special element state by compiled special element index
+    std::vector<SpecialElementState> specelStates;
+
+    // gate inputs raised this cycle (indices of the GateNetwork)
+    std::vector<uint8_t> gateInputHigh;
+    std::vector<uint32_t> gateHighCount;
+    std::vector<uint64_t> gateAny;
+    std::vector<uint64_t> gateAll;
+    std::vector<uint32_t> raisedGateInputs;
+    std::vector<uint32_t> raisedGates;
+    // special elements that calculated true in the last cycle
+    std::vector<uint32_t> firedSpecialElements;
+
+    // compiled graph this context is sized for; kept alive by the context
+    std::shared_ptr<const CompiledAutomata> compiled;
+
+    // reports go to reportSink, by default the reports vector
+    ReportVectorSink reports;
+    ReportSink *reportSink;
+
+    // element id and report code view of the reports vector, built on demand
+    std::vector<std::pair<uint64_t, std::string>> reportVector;
+    std::vector<std::string> reportCodes;
+    void resolveReports();
+
+    // Simulation Statistics
+    std::unordered_map<uint32_t, std::list<std::string>> activationVector;
+    std::unordered_map<std::string, uint32_t> activationHist;
+    std::vector<uint32_t> enabledHist;
+    std::vector<uint32_t> activatedHist;
+    uint32_t maxActivations;
+    std::unordered_map<Element*, uint32_t> enabledCount;
+    std::unordered_map<Element*, uint32_t> activatedCount;
+    std::queue<Element *> enabledLastCycle;
+    std::queue<Element *> activatedLastCycle;
+    std::queue<Element *> reportedLastCycle;
+
+    // position in the input stream
+    uint64_t cycle;
+    uint64_t progress_length;
+    bool end_of_data;
+
+public:
+    SimulationContext();
+    SimulationContext(std::shared_ptr<const CompiledAutomata> compiled);
+    SimulationContext(const SimulationContext &) = delete;
+    ~SimulationContext();
+
+    void resize(std::shared_ptr<const CompiledAutomata> compiled);
+    void clearGateInputs();
+    void clearSpecialElementStates();
+    void reset();
+    void clearEnabledSTEs();
+    void copyState(const SimulationContext &other);
+    bool hasSameState(const SimulationContext &other) const;
+
+    inline uint64_t getCycle() { return cycle; }
+    inline bool isEndOfData() { return end_of_data; }
+    inline void setEndOfData(bool eod) { end_of_data = eod; }
+    void setReportSink(ReportSink *sink);
+    inline ReportSink *getReportSink() { return reportSink; }
+    inline std::vector<Report> &getReports() { return reports.getReports(); }
+    std::vector<std::pair<uint64_t, std::string>> &getReportVector();
+    std::vector<std::string> &getReportCodes();
+    inline std::unordered_map<Element*, uint32_t> &getEnabledCount() { return enabledCount; }
+    inline std::unordered_map<Element*, uint32_t> &getActivatedCount() { return activatedCount; }
+};
+
+#endif
@@ -11,14 +11,46 @@
 #include <iostream>
 #include <unordered_map>
 
+/*
+ * Per-run state of one special element. A SimulationContext keeps one
+ *  per compiled special element, so the Element objects are read-only
+ *  during simulation. port_high counts the inputs raised on each port
+ *  this cycle; gates are raised through the GateNetwork instead.
+ */
+struct SpecialElementState {
+    uint32_t port_high[3];
+    uint32_t value;
+    bool enabled;
+    bool activated;
+    bool dormant;
+    bool latched;
+};
+
+/*
+ * The inputs map only describes structure; its values are not updated
+ *  during simulation. Input signals are raised in a SpecialElementState
+ *  and calculate() only reads the number of high inputs per port.
+ */
 class SpecialElement: public Element {
 
+protected:
+    // number of inputs per port
+    uint32_t num_inputs;
+    uint32_t port_inputs[3];
+
 public:
     SpecialElement(std::string id);
     ~SpecialElement();
+    void compileInputs();
     virtual void enable(std::string id);
     virtual void disable();
-    virtual bool calculate() = 0;
+
+    inline uint32_t getNumInputs() { return num_inputs; }
+    inline uint32_t getNumInputs(ElementPort port) { return port_inputs[port]; }
+    static inline uint32_t getNumHighInputs(const SpecialElementState &state) {
+        return state.port_high[PORT_NONE] + state.port_high[PORT_CNT] + state.port_high[PORT_RST];
+    }
+    virtual bool calculate(SpecialElementState &state) = 0;
     virtual bool isSpecialElement();
     virtual std::string toString() = 0;
     virtual std::string toANML() = 0;
@@ -23,58 +23,62 @@ protected:
 
 public:
     Stack();
+    Stack(const Stack &) = delete;
+    Stack &operator=(const Stack &) = delete;
     ~Stack();
     void push_back(T const &);
     void pop_back();
     T back() const;
-    uint32_t size();
+    T get(uint32_t) const;
+    uint32_t size() const;
     bool empty() const {
         return (top == 0);
     }
 };
 
 /*
- *
+ * Storage is allocated by the first push, so unused stacks are free
  */
 template <class T>
 Stack<T>::Stack() {
 
     top = 0;
-    max_size = INITIAL;
-    stack = new T[INITIAL];
+    max_size = 0;
+    stack = NULL;
 
 }
 
 /*
- *
+ * Stacks own their storage, so they cannot be copied
  */
 template <class T>
 Stack<T>::~Stack() {
 
-
+    delete [] stack;
 }
 
 template <class T>
 inline void Stack<T>::push_back(T const& el) {
 
-    stack[top] = el;
-    top++;
-
     //Double size of stack if necessary
     if(top == max_size){
 
         //printf("RESIZING!\n");
 
-        T *stack_temp = new T[max_size*2];
+        uint32_t new_size = (max_size == 0) ? INITIAL : max_size*2;
+        T *stack_temp = new T[new_size];
         // copy contents
         for(uint32_t i = 0; i < max_size; i++){
             stack_temp[i] = stack[i];
         }
 
-        max_size *=2;
-        delete stack;
+        max_size = new_size;
+        delete [] stack;
         stack = stack_temp;
     }
+
+    stack[top] = el;
+    top++;
 }
 
 template <class T>
@@ -87,8 +91,16 @@ inline T Stack<T>::back() const{
     return stack[top - 1];
 }
 
+/*
+ * Returns the element at position i, counted from the bottom
+ */
+template <class T>
+inline T Stack<T>::get(uint32_t i) const{
+    return stack[i];
+}
+
 template <class T>
-inline uint32_t Stack<T>::size() {
+inline uint32_t Stack<T>::size() const{
     return top;
 }
 
@@ -30,6 +30,7 @@ protected:
 public:
 
     STE(std::string id, std::string symbol_set, std::string start);
+    STE(std::string id, std::string symbol_set, std::bitset<256> bit_column, std::string start);
     ~STE();
 
     virtual ElementType getType();
@@ -71,6 +72,9 @@ public:
     bool leftCompare(STE*);
     bool rightCompare(STE*);
     bool identicalProperties(STE*);
+    uint64_t leftSignature();
+    uint64_t rightSignature();
+    uint64_t pathSignature();
     int compareSymbolSet(STE*);
     void merge(STE*);
     STE* clone();
@@ -0,0 +1,78 @@
+/**
+ * @file
+ */
+#ifndef STREAM_SCANNER_H
+#define STREAM_SCANNER_H
+
+#include "simulationContext.h"
+#include "reportSink.h"
+
+#include <stdint.h>
+#include <vector>
+
+class Automata;
+
+// streams scanned in lockstep by one thread in a batch
+#define STREAM_SCANNER_DEFAULT_INTERLEAVE 8
+
+// handle of one open input stream of a StreamScanner
+typedef uint32_t StreamHandle;
+
+/*
+ * A piece of one input stream for StreamScanner::scan(). end marks the
+ *  last piece of the stream, whose last symbol is end of data.
+ */
+struct StreamBlock {
+    StreamHandle stream;
+    uint8_t *data;
+    uint64_t length;
+    bool end;
+};
+
+/*
+ * Scans many independent input streams (flows, files, records) against
+ *  one shared automata. Every open stream is a handle to its own
+ *  SimulationContext, so a stream can be fed piece by piece and keeps
+ *  its state in between. Closed handles and their contexts are reused,
+ *  and resetting a stream only touches its enabled STEs, so short
+ *  streams cost little more than their symbols. A batch of pieces of
+ *  different streams is scanned concurrently; pieces of the same stream
+ *  are scanned in batch order. Each thread advances up to
+ *  getInterleave() streams in lockstep (see Automata::simulateInterleaved)
+ *  to overlap their memory accesses. Reports of every stream go to its
+ *  own sink, by default collected in its context.
+ */
+class StreamScanner {
+
+private:
+    Automata *automata;
+    uint32_t interleave;
+
+    // context of every handle; closed handles are kept for reuse
+    std::vector<SimulationContext *> streams;
+    std::vector<uint8_t> opened;
+    std::vector<uint8_t> started;
+    std::vector<StreamHandle> closed;
+
+    void start(StreamHandle stream);
+    void scanInterleaved(std::vector<StreamBlock> &blocks, std::vector<uint32_t> &order, std::vector<uint32_t> &runs, uint32_t first, uint32_t last);
+
+public:
+    StreamScanner(Automata *automata);
+    ~StreamScanner();
+
+    StreamHandle open(ReportSink *sink = NULL);
+    void close(StreamHandle stream);
+    void reset(StreamHandle stream);
+
+    void scan(StreamHandle stream, uint8_t *data, uint64_t length, bool end);
+    void scan(std::vector<StreamBlock> &blocks, uint32_t num_threads);
+
+    inline void setInterleave(uint32_t k) { interleave = (k < 1) ? 1 : k; }
+    inline uint32_t getInterleave() { return interleave; }
+    inline uint32_t getNumOpenStreams() { return streams.size() - closed.size(); }
+    inline SimulationContext &getContext(StreamHandle stream) { return *streams[stream]; }
+    inline std::vector<Report> &getReports(StreamHandle stream) { return streams[stream]->getReports(); }
+};
+
+#endif
@@ -17,7 +17,7 @@
 #include <ios>
 #include <iterator>
 
-uint32_t fileSize(std::string fn);
+uint64_t fileSize(std::string fn);
 void inputFileCheck();
 std::vector<unsigned char> file2CharVector(std::string fn);
 uint8_t * parseInputStream(bool simulate, bool input_string, uint64_t *size, char ** argv, uint32_t optind);
@@ -28,6 +28,7 @@ void writeIntVectorToFile(std::vector<uint32_t> &vec, std::string fn);
 std::string getFileExt(const std::string& s);
 void setRange(std::bitset<256> &column, int start, int end, int value);
 void parseSymbolSet(std::bitset<256> &column, std::string symbol_set);
+uint64_t hashCombine(uint64_t seed, uint64_t value);
 
 
 /*
@@ -0,0 +1,69 @@
+/**
+ * @file
+ */
+#ifndef WORK_STEALING_SCHEDULER_H
+#define WORK_STEALING_SCHEDULER_H
+
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+// default size of the input blocks scheduled as tasks (bytes)
+#define SCHEDULER_DEFAULT_BLOCK_SIZE (64ULL << 10)
+
+// component groups per worker, so that there is something left to steal
+#define SCHEDULER_GROUPS_PER_WORKER 4
+
+class WorkStealingScheduler;
+
+// a task gets the scheduler and the worker running it, so it can spawn follow-up tasks
+typedef std::function<void(WorkStealingScheduler &, uint32_t)> SchedulerTask;
+
+/*
+ * Runs tasks on a fixed number of worker threads. Every worker owns a
+ *  deque of tasks. A worker pushes and pops at the back of its own deque,
+ *  so a follow-up task spawned by a task runs next on the same worker
+ *  while its data is still in cache; idle workers steal the oldest task
+ *  from the front of other workers' deques. Ordered work, e.g. the input
+ *  blocks of one stream, is expressed by spawning the next piece at the
+ *  end of the previous one.
+ */
+class WorkStealingScheduler {
+
+private:
+    struct Worker {
+        std::deque<SchedulerTask> tasks;
+        std::mutex lock;
+    };
+
+    std::vector<Worker *> workers;
+
+    // tasks pushed but not yet finished
+    std::atomic<uint64_t> pending;
+
+    // tasks pushed before run() are dealt out round robin
+    uint32_t next_worker;
+
+    // statistics
+    std::atomic<uint64_t> steals;
+
+    bool pop(uint32_t worker, SchedulerTask &task);
+    bool steal(uint32_t worker, SchedulerTask &task);
+    void work(uint32_t worker);
+
+public:
+    WorkStealingScheduler(uint32_t num_workers);
+    ~WorkStealingScheduler();
+
+    void push(SchedulerTask task);
+    void spawn(uint32_t worker, SchedulerTask task);
+    void run();
+
+    inline uint32_t getNumWorkers() { return workers.size(); }
+    inline uint64_t getNumSteals() { return steals.load(); }
+};
+
+#endif
@@ -23,19 +23,10 @@ AND::~AND() {
 /*
  * DOES AND OPERATION OVER INPUTS
  */
-bool AND::calculate() {
+bool AND::calculate(SpecialElementState &state) {
     
-    bool result = true;
-    
-    for(auto e : inputs) {
-        result = result && e.second;
-    }
-
-    if(inputs.size() > 0)
-        return result;
-    else{
-        return false;
-    }
+    // all inputs must be high
+    return getNumInputs() > 0 && getNumHighInputs(state) == getNumInputs();
 }
 
 /*
@@ -6,6 +6,37 @@
 using namespace std;
 using namespace MNRL;
 
+// specializations of the simulation step and loop, indexed by SimulationFeature bits
+typedef void (Automata::*SimulationStep)(SimulationContext &, uint8_t);
+typedef void (Automata::*SimulationLoop)(SimulationContext &, uint8_t *, uint64_t, bool);
+
+template<uint32_t F>
+struct SimulationVariants {
+    static void fill(SimulationStep *steps, SimulationLoop *loops) {
+        if(F < SIM_NUM_STEP_VARIANTS)
+            steps[F % SIM_NUM_STEP_VARIANTS] = &Automata::simulateStep<F % SIM_NUM_STEP_VARIANTS>;
+        loops[F] = &Automata::simulateLoop<F>;
+        SimulationVariants<F - 1>::fill(steps, loops);
+    }
+};
+
+template<>
+struct SimulationVariants<0> {
+    static void fill(SimulationStep *steps, SimulationLoop *loops) {
+        steps[0] = &Automata::simulateStep<0>;
+        loops[0] = &Automata::simulateLoop<0>;
+    }
+};
+
+static struct SimulationVariantTable {
+    SimulationStep steps[SIM_NUM_STEP_VARIANTS];
+    SimulationLoop loops[SIM_NUM_LOOP_VARIANTS];
+
+    SimulationVariantTable() {
+        SimulationVariants<SIM_NUM_LOOP_VARIANTS - 1>::fill(steps, loops);
+    }
+} simulation_variants;
+
 
 /**
  * Constructs an empty Automata object.
@@ -24,14 +55,18 @@ Automata::Automata() {
     // Enable output by default
     setQuiet(false);
 
-    // Initialize cycle to start at 0
-    cycle = 0;
-
     // End of data is false until last cycle
     setEndOfData(false);
     
     // debug
     setDumpState(false, 0);
+
+    // compiled graph and alternative engines are built on demand
+    compiled = nullptr;
+    prefilter = NULL;
+    bitParallelEngine = NULL;
+    lazyDFAEngine = NULL;
+    lazyDFACacheSize = LAZY_DFA_DEFAULT_CACHE_SIZE;
 }
 
 /**
@@ -62,10 +97,22 @@ void Automata::finalizeAutomata() {
         validateReportElement(parent);
         
     }
+
+    // build the flat representation used by simulation
+    compileAutomata();
+}
+
+/**
+ * Builds the CompiledAutomata used by the simulation hot path from the current graph and resets all STE simulation state. Special elements are compiled in an order where every special element is evaluated after all of its special element parents. Called by finalizeAutomata() and on demand by initializeSimulation() after the graph was modified.
+ */
+CompiledAutomata *Automata::compileAutomata() {
+
+    invalidateCompiledAutomata();
     
     //
     // collect special elements in BFS order in orderedSpecialElements vector
     //
+    orderedSpecialElements.clear();
     unmarkAllElements();
 
     queue<Element *> workq;
@@ -80,7 +127,6 @@ void Automata::finalizeAutomata() {
     }
             
     //
-    queue<Element *> next_worq;
     while(!workq.empty()){
 
         Element *el = workq.front();
@@ -111,15 +157,59 @@ void Automata::finalizeAutomata() {
         }
     }
 
-    // print out ordered special elements
-    //uint32_t counter = 0;
-    //for(Element *el : orderedSpecialElements){
-    //    cout << counter++ << " : " << el->getId() << endl;
-    //}
+    unmarkAllElements();
+
+    // flatten the graph; STEs are placed in BFS order for locality
+    vector<STE*> ordered_stes = orderSTEsBreadthFirst();
+    vector<SpecialElement*> ordered_specels;
+    for(Element *el : orderedSpecialElements) {
+        ordered_specels.push_back(static_cast<SpecialElement*>(el));
+    }
+
+    compiled = make_shared<CompiledAutomata>(ordered_stes, ordered_specels);
+
+    // count special element inputs per port
+    compileSpecialElementInputs();
+
+    // idle input skipping is decided once per graph so contexts can share it
+    prefilter = new Prefilter(compiled.get());
+
+    // size STE and gate simulation state to the new graph
+    context.resize(compiled);
+
+    return compiled.get();
 }
 
 /**
- * Constructs an automata object based on a string file name and a file type. Supported file types are "anml" and "mnrl". All unrecognized file types are assumed to be anml.
+ * Counts the inputs of every special element per port. Simulation raises special element inputs through the GateNetwork of the compiled graph, by index instead of by "fromElementId:toPort" string. Called by compileAutomata().
+ */
+void Automata::compileSpecialElementInputs() {
+
+    for(auto e : specialElements) {
+        e.second->compileInputs();
+    }
+}
+
+/**
+ * Discards the compiled graph and any engine built from it. Called whenever the graph is modified through the Automata interface.
+ */
+void Automata::invalidateCompiledAutomata() {
+
+    delete bitParallelEngine;
+    bitParallelEngine = NULL;
+
+    delete lazyDFAEngine;
+    lazyDFAEngine = NULL;
+
+    delete prefilter;
+    prefilter = NULL;
+
+    // contexts keep their own reference to the compiled graph
+    compiled = nullptr;
+}
+
+/**
+ * Constructs an automata object based on a string file name and a file type. Supported file types are "anml", "mnrl" and "binary". All unrecognized file types are assumed to be anml.
  */
 void Automata::parseAutomataFile(string fn, string filetype) {
 
@@ -131,6 +221,12 @@ void Automata::parseAutomataFile(string fn, string filetype) {
         MNRLAdapter parser(filename);
         // TODO:: GET THIS TO RETURN PROPER ERROR CODE
         parser.parse(elements, starts, reports, specialElements, &id, activateNoInputSpecialElements);  
+    } else if(filetype.compare("binary") == 0){
+        // Map precompiled automata; edges are already wired
+        BinaryAutomataParser parser(filename);
+        vasim_err_t result = parser.parse(elements, starts, reports, specialElements, &id, activateNoInputSpecialElements);
+
+        setErrorCode(result);
     } else {
         // Read in automata description from ANML file
         ANMLParser parser(filename);
@@ -142,30 +238,28 @@ void Automata::parseAutomataFile(string fn, string filetype) {
 }
 
 /** 
- * Constructs an Automata object from a given ANML or MNRL homogeneous automata description file and the file type "mnrl" or "anml".
+ * Constructs an Automata object from a given ANML, MNRL or binary automata file and the file type "mnrl", "anml" or "binary".
  */
 Automata::Automata(string fn, string filetype) : Automata() {
 
     parseAutomataFile(fn, filetype);
 
-    finalizeAutomata();
+    // binary automata are loaded fully wired
+    if(filetype.compare("binary") == 0) {
+        compileAutomata();
+    } else {
+        finalizeAutomata();
+    }
 }
 
 
 /**
- * Constructs an Automata object from a given ANML or MNRL homogeneous automata description file. Automatically determines file type based on the file extension. Currently VASim only supports MNRL (.mnrl) and ANML (.anml) files.
+ * Constructs an Automata object from a given ANML or MNRL homogeneous automata description file or a binary automata file. Automatically determines file type based on the file extension. Currently VASim only supports MNRL (.mnrl), ANML (.anml) and binary (.vab) files.
  */
-Automata::Automata(string fn) : Automata() {
-
-    
-    // Read Automata from file based on extension
-    if(getFileExt(fn).compare("mnrl") == 0) {
-        parseAutomataFile(fn, "mnrl");
-    } else {
-        parseAutomataFile(fn, "anml");
-    }
+Automata::Automata(string fn) : Automata(fn, getFileExt(fn).compare("mnrl") == 0 ? "mnrl" :
+                                             getFileExt(fn).compare(BINARY_AUTOMATA_EXTENSION) == 0 ? "binary" :
+                                             "anml") {
 
-    finalizeAutomata();
 }
 
 
@@ -184,48 +278,16 @@ void Automata::reset() {
     // unmark all elements
     unmarkAllElements();
     
-    // clear all functional maps
-    while(!enabledSTEs.empty())
-        enabledSTEs.pop_back();
-
-    while(!activatedSTEs.empty())
-        activatedSTEs.pop_back();
-
-    while(!latchedSTEs.empty())
-        latchedSTEs.pop_back();
-    
-    while(!enabledSpecialElements.empty())
-        enabledSpecialElements.pop();
-
-    while(!activatedSpecialElements.empty())
-        activatedSpecialElements.pop();
-
-    latchedSpecialElements.clear();
+    // clear all simulation state and statistics
+    context.reset();
     activateNoInputSpecialElements.clear();    
 
-    // Reset all simulation stats
-    activationVector.clear();
-    activationHist.clear();
-    enabledHist.clear();
-    activatedHist.clear();
-    maxActivations = 0;
-    enabledCount.clear();
-    activatedCount.clear();
-
-    while(!enabledLastCycle.empty())
-        enabledLastCycle.pop();
+    // reset alternative engine state
+    if(bitParallelEngine != NULL)
+        bitParallelEngine->reset();
 
-    while(!activatedLastCycle.empty())
-        activatedLastCycle.pop();
-
-    while(!reportedLastCycle.empty())
-        reportedLastCycle.pop();
-
-    // clear report vector
-    reportVector.clear();
-
-    // reset cycle counter to be 0
-    cycle = 0;
+    if(lazyDFAEngine != NULL)
+        lazyDFAEngine->reset();
     
 }
 
@@ -238,7 +300,7 @@ void Automata::copyFlagsFrom(Automata *a) {
     setQuiet(a->quiet);
     setReport(a->report);
     setDumpState(a->dump_state, a->dump_state_cycle);
-    setEndOfData(a->end_of_data);
+    setEndOfData(a->context.isEndOfData());
 
 }
 
@@ -273,6 +335,8 @@ void Automata::addSTE(STE *ste, vector<string> &outputs) {
  */
 void Automata::rawAddSTE(STE *ste) {
 
+    invalidateCompiledAutomata();
+
     elements[ste->getId()] = static_cast<Element *>(ste);
 
     if(ste->isStart()){
@@ -289,6 +353,8 @@ void Automata::rawAddSTE(STE *ste) {
  */
 void Automata::rawAddSpecialElement(SpecialElement *specel) {
 
+    invalidateCompiledAutomata();
+
     specialElements[specel->getId()] = specel;
     elements[specel->getId()] = static_cast<Element *>(specel);
 
@@ -310,14 +376,17 @@ void Automata::rawAddSpecialElement(SpecialElement *specel) {
  */
 void Automata::leftMergeSTEs(STE *ste1, STE *ste2) {
 
+    // copy; removing edges modifies ste2's outputs
+    vector<pair<Element *, string>> outputs = ste2->getOutputSTEPointers();
+
     // add all outputs from ste2 to ste1
-    for(auto e : ste2->getOutputSTEPointers()){
+    for(auto e : outputs){
         STE *output = static_cast<STE*>(e.first);
         addEdge(ste1, output);
     }
 
     // remove all edges from ste2 to output
-    for(auto e : ste2->getOutputSTEPointers()){
+    for(auto e : outputs){
         STE *output = static_cast<STE*>(e.first);
         removeEdge(ste2, output);
     }
@@ -326,92 +395,89 @@ void Automata::leftMergeSTEs(STE *ste1, STE *ste2) {
 }
 
 /**
- * Returns a vector of every connected component automaton as a separate Automata object. Does not delete the original automata.
+ * Returns the representative of the disjoint set containing x. Halves the path on the way up.
  */
-vector<Automata*> Automata::splitConnectedComponents() {
+static uint32_t findSet(vector<uint32_t> &parent, uint32_t x) {
 
-    // unmark all elements
-    unmarkAllElements();
+    while(parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
 
-    vector<Automata*> connectedComponents;
-    uint32_t index = 0;
+    return x;
+}
 
-    // For each start state
-    for(STE *start : starts){
+/**
+ * Joins the disjoint sets containing a and b, hanging the smaller set below the larger one.
+ */
+static void unionSets(vector<uint32_t> &parent, vector<uint32_t> &size, uint32_t a, uint32_t b) {
 
-        // If start state was already marked, don't consider it;
-        if(start->isMarked())
-            continue;
-        // Create new automata in vector
-        Automata *m = new Automata();
-        connectedComponents.push_back(m);
-        index++;
+    a = findSet(parent, a);
+    b = findSet(parent, b);
 
-        // Do a breadth first search marking all children and parents
-        // BFS work queue
-        queue<Element *> workq;
-        // MARK BEFORE ADDING TO QUEUE
-        start->mark();
-        workq.push(start);
-        uint32_t counter = 0;
-        while(!workq.empty()){
-            // mark head of queue and pop current
-            Element *current = workq.front();
-            workq.pop();
-            counter++;
+    if(a == b)
+        return;
 
-            // add to new automata
-            if(!current->isSpecialElement()){
-                STE *current_ste = static_cast<STE*>(current);
-                connectedComponents[index-1]->rawAddSTE(current_ste);
-            }else{
-                SpecialElement *current_specel = static_cast<SpecialElement*>(current);
-                connectedComponents[index-1]->rawAddSpecialElement(current_specel);
-            }
+    if(size[a] < size[b])
+        swap(a, b);
 
-            set<Element *> unique_workq_adds;
-            // add all unique children of current to workq if not already marked
-            for(auto out : current->getOutputSTEPointers()){
-                if(!out.first->isMarked()){
-                    //workq.push(out.first);
-                    unique_workq_adds.insert(out.first);
-                }
-            }
+    parent[b] = a;
+    size[a] += size[b];
+}
 
-            for(auto out : current->getOutputSpecelPointers()){
-                if(!out.first->isMarked()){
-                    //workq.push(out.first);
-                    unique_workq_adds.insert(out.first);
-                }
-            }
+/**
+ * Returns a vector of every connected component automaton as a separate Automata object. Does not delete the original automata. Components are found with a union-find over the edges of the integer graph and are ordered by their first start state; components without start states are dropped. Runs in near linear time.
+ */
+vector<Automata*> Automata::splitConnectedComponents() {
 
-            // Add all parents of current to workq if not already marked
-            // Get unique parents
-            for(auto input : current->getInputs()){
-                // only keep track of unique inputs
-                Element * to_add = getElement(input.first);
+    vector<Automata*> connectedComponents;
 
-                if(to_add == nullptr){
-                    cout << input.first << endl;
-                    cout << Element::stripPort(input.first) << endl;
-                }
+    // union the ends of every edge; no edge resolves a string id
+    ElementGraph graph(elements);
+    uint32_t n = graph.size();
+    vector<uint32_t> parent(n);
+    vector<uint32_t> size(n, 1);
+    for(uint32_t i = 0; i < n; i++)
+        parent[i] = i;
 
-                if(!to_add->isMarked()){
-                    unique_workq_adds.insert(to_add);
-                }
-            }
+    for(uint32_t i = 0; i < n; i++) {
+        for(const GraphEdge *e = graph.succBegin(i); e != graph.succEnd(i); e++)
+            unionSets(parent, size, i, e->node);
+    }
 
-            // Add unique elements to workq
-            for(Element * add : unique_workq_adds){
-                if(!add->isMarked()){
-                    // MARK BEFORE ADDING TO QUEUE
-                    add->mark();
-                    workq.push(add);
-                }
-            }
-        } // workq loop
-        //cout << "Added " << counter << " Elements to new automata..." << endl;
-        counter = 0;
+    // number the sets in order of their first start state
+    const uint32_t no_component = UINT32_MAX;
+    vector<uint32_t> component(n, no_component);
+    for(STE *start : starts) {
+        uint32_t root = findSet(parent, graph.getId(start));
+        if(component[root] == no_component) {
+            component[root] = connectedComponents.size();
+            connectedComponents.push_back(new Automata());
+        }
+    }
+
+    // size every component up front so adding elements never rehashes
+    vector<uint32_t> members(connectedComponents.size(), 0);
+    for(uint32_t i = 0; i < n; i++) {
+        component[i] = component[findSet(parent, i)];
+        if(component[i] != no_component)
+            members[component[i]]++;
+    }
+
+    for(uint32_t c = 0; c < connectedComponents.size(); c++)
+        connectedComponents[c]->elements.reserve(members[c]);
+
+    for(uint32_t i = 0; i < n; i++) {
+        if(component[i] == no_component)
+            continue;
+
+        Automata *m = connectedComponents[component[i]];
+        Element *current = graph.getElement(i);
+        if(!current->isSpecialElement()){
+            m->rawAddSTE(static_cast<STE*>(current));
+        }else{
+            m->rawAddSpecialElement(static_cast<SpecialElement*>(current));
+        }
     }
 
     if(!quiet)
@@ -461,13 +527,19 @@ Automata *Automata::clone() {
  */
 void Automata::removeElement(Element *el) {
 
+    invalidateCompiledAutomata();
+
+    // copy; removing edges modifies el's edge lists
+    vector<string> outputs = el->getOutputs();
+    map<string, bool> inputs = el->getInputs();
+
     // remove traces from output elements
-    for(string output : el->getOutputs()){
+    for(string output : outputs){
         removeEdge(el->getId(), output);
     }
 
     // remove traces from input elements
-    for(pair<string, bool> in : el->getInputs()){
+    for(pair<string, bool> in : inputs){
         removeEdge(in.first, el->getId());
     }
 
@@ -515,7 +587,7 @@ vector<Element *> &Automata::getReports() {
  */
 std::vector<std::pair<uint64_t, std::string>> &Automata::getReportVector() {
 
-    return reportVector;
+    return context.getReportVector();
 }
 
 /**
@@ -540,7 +612,7 @@ unordered_map<string, SpecialElement *> &Automata::getSpecialElements() {
  */
 queue<Element *> &Automata::getEnabledLastCycle() {
 
-    return enabledLastCycle;
+    return context.enabledLastCycle;
 }
 
 /**
@@ -548,7 +620,7 @@ queue<Element *> &Automata::getEnabledLastCycle() {
  */
 queue<Element *> &Automata::getActivatedLastCycle() {
 
-    return activatedLastCycle;
+    return context.activatedLastCycle;
 }
 
 /**
@@ -556,7 +628,7 @@ queue<Element *> &Automata::getActivatedLastCycle() {
  */
 queue<Element *> &Automata::getReportedLastCycle() {
 
-    return reportedLastCycle;
+    return context.reportedLastCycle;
 }
 
 
@@ -565,7 +637,7 @@ queue<Element *> &Automata::getReportedLastCycle() {
  */
 unordered_map<string, uint32_t> &Automata::getActivationHist() {
 
-    return activationHist;
+    return context.activationHist;
 }
 
 /**
@@ -573,7 +645,7 @@ unordered_map<string, uint32_t> &Automata::getActivationHist() {
  */
 uint32_t Automata::getMaxActivations() {
 
-    return maxActivations;
+    return context.maxActivations;
 }
 
 /**
@@ -586,8 +658,8 @@ void Automata::setProfile(bool profile_flag) {
     // If we're profiling, map STEs to a counter for each state
     if(profile){
 	for(auto e : elements) {
-            enabledCount[e.second] = 0;
-            activatedCount[e.second] = 0;
+            context.enabledCount[e.second] = 0;
+            context.activatedCount[e.second] = 0;
         }
     }
 }
@@ -617,7 +689,61 @@ void Automata::setDumpState(bool dump_flag, uint64_t dump_cycle) {
  * Sets end of data flag. If any reporting elements only report on end of data and this flag is set, the elements will report.
  */
 void Automata::setEndOfData(bool eod) {
-    end_of_data = eod;
+    context.end_of_data = eod;
+}
+
+/**
+ * Returns the current symbol cycle.
+ */
+uint64_t Automata::getCycle() {
+    return context.cycle;
+}
+
+/**
+ * Sets the memory budget in bytes of the lazy DFA transition cache. Discards any existing cache.
+ */
+void Automata::setLazyDFACacheSize(uint64_t bytes) {
+
+    lazyDFACacheSize = bytes;
+
+    delete lazyDFAEngine;
+    lazyDFAEngine = NULL;
+}
+
+/**
+ * Returns the lazy DFA engine used by simulateLazyDFA(), or NULL if it has not run since the graph last changed.
+ */
+LazyDFAEngine *Automata::getLazyDFAEngine() {
+    return lazyDFAEngine;
+}
+
+/**
+ * Returns the simulation context used by all simulation functions that are not given a context explicitly.
+ */
+SimulationContext &Automata::getSimulationContext() {
+    return context;
+}
+
+/**
+ * Returns the compiled graph, compiling the automata if needed. The compiled graph resolves the compiled ids sent to report sinks to element ids and report codes.
+ */
+CompiledAutomata *Automata::getCompiledAutomata() {
+
+    if(compiled == NULL)
+        compileAutomata();
+
+    return compiled.get();
+}
+
+/**
+ * Creates a new, empty simulation context for this automata. Compiles the automata if needed, so contexts can then be simulated concurrently against the read-only compiled graph. The caller owns the context; it is invalid once the graph is modified.
+ */
+SimulationContext *Automata::newSimulationContext() {
+
+    if(compiled == NULL)
+        compileAutomata();
+
+    return new SimulationContext(compiled);
 }
 
 
@@ -638,14 +764,35 @@ void Automata::print() {
  */
 void Automata::simulate(uint8_t symbol, vector<string> injects) {
 
+    if(compiled == NULL)
+        compileAutomata();
+
     // enable all element children of injected signal
     for(string inject : injects) {
 
         Element *el = getElement(inject);
-        el->enableChildSTEs(&enabledSTEs);
-        if(specialElements.size() > 0)
-            el->enableChildSpecialElements(&enabledSpecialElements);
-        
+        uint32_t index;
+        if(compiled->getIndex(el, &index)) {
+            const GateNetwork *gates = compiled->getGateNetwork();
+            if(el->isSpecialElement()) {
+                enableSpecialElementChildSTEs(context, index);
+                raiseGateInputs(context, gates->getSpecialElementTargetsBegin(index), gates->getSpecialElementTargetsEnd(index));
+                raiseSpecialElementPorts(context, gates->getSpecialElementPortTargetsBegin(index), gates->getSpecialElementPortTargetsEnd(index));
+            } else {
+                raiseGateInputs(context, gates->getSTETargetsBegin(index), gates->getSTETargetsEnd(index));
+                raiseSpecialElementPorts(context, gates->getSTEPortTargetsBegin(index), gates->getSTEPortTargetsEnd(index));
+
+                const CompiledSTE &ste = compiled->getSTE(index);
+                const uint32_t *successors = compiled->getSuccessors();
+                for(uint32_t k = ste.succ_begin; k < ste.succ_end; k++) {
+                    uint32_t child = successors[k];
+                    if(!context.steEnabled[child]) {
+                        context.steEnabled[child] = 1;
+                        context.enabledSTEs.push_back(child);
+                    }
+                }
+            }
+        }
     }
 
     simulate(symbol);
@@ -656,83 +803,137 @@ void Automata::simulate(uint8_t symbol, vector<string> injects) {
  */
 void Automata::simulate(uint8_t symbol) {
 
+    simulate(context, symbol);
+}
+
+/**
+ * Simulates the automata on a single input symbol in the given simulation context.
+ */
+void Automata::simulate(SimulationContext &ctx, uint8_t symbol) {
+
+    SimulationStep step = simulation_variants.steps[getSimulationFeatures() % SIM_NUM_STEP_VARIANTS];
+    (this->*step)(ctx, symbol);
+}
+
+/**
+ * Returns the SimulationFeature bits needed to simulate this automata with the current flags. Selects the specialized simulation step and loop.
+ */
+uint32_t Automata::getSimulationFeatures() {
+
+    if(compiled == NULL)
+        compileAutomata();
+
+    uint32_t features = 0;
+
+    if(report)
+        features |= SIM_REPORT;
+
+    if(compiled->usesEndOfData())
+        features |= SIM_EOD;
+
+    if(specialElements.size() > 0)
+        features |= SIM_SPECELS;
+
+    if(profile || dump_state)
+        features |= SIM_DEBUG;
+
+    if(!quiet)
+        features |= SIM_PROGRESS;
+
+    // idle input can only be skipped if no state lives outside the STE stacks
+    if(!(features & (SIM_SPECELS | SIM_DEBUG)) && prefilter->canSkip())
+        features |= SIM_SKIP_IDLE;
+
+    return features;
+}
+
+/**
+ * Simulates one input symbol with the features F. Features that are not in F are compiled out, so the step does not test them.
+ */
+template<uint32_t F>
+void Automata::simulateStep(SimulationContext &ctx, uint8_t symbol) {
+
     
     // -----------------------------
     // Step 1: if STEs are enabled and we match, activate
-    computeSTEMatches(symbol);
+    computeSTEMatches<F>(ctx, symbol);
     // -----------------------------
 
     
-    // Activation Statistics
-    if(profile){
-        profileActivations();
-    }
+    if(F & SIM_DEBUG) {
+
+        // Activation Statistics
+        if(profile){
+            profileActivations(ctx);
+        }
 
-    // Debug state
-    if(dump_state && (dump_state_cycle == cycle)){
-        dumpSTEState("stes_" + to_string(cycle) + ".state");
+        // Debug state
+        if(dump_state && (dump_state_cycle == ctx.cycle)){
+            dumpSTEState(ctx, "stes_" + to_string(ctx.cycle) + ".state");
+        }
     }
 
     // -----------------------------
     // Step 2: enable children of matching STEs
-    enableSTEMatchingChildren();
+    enableSTEMatchingChildren<F>(ctx);
     // -----------------------------
 
 
     // -----------------------------
     // Step 3:  enable all-input start states
-    enableStartStates(end_of_data);
+    enableStartStates<F>(ctx, (F & SIM_EOD) && ctx.end_of_data);
     // -----------------------------
 
     
     // -----------------------------
     // Step 4: special element computation
-    if(specialElements.size() > 0){        
-        specialElementSimulation2();
+    if(F & SIM_SPECELS){        
+        specialElementSimulation2(ctx);
 
-        if(dump_state && (dump_state_cycle == cycle)){
-            dumpSpecelState("specels_" + to_string(cycle) + ".state");
+        if((F & SIM_DEBUG) && dump_state && (dump_state_cycle == ctx.cycle)){
+            dumpSpecelState(ctx, "specels_" + to_string(ctx.cycle) + ".state");
         }
     }
     // -----------------------------
 
     // Enabled Statistics
-    if(profile){
-        profileEnables();
+    if((F & SIM_DEBUG) && profile){
+        profileEnables(ctx);
     }
     
     // advance cycle count
-    tick();
+    tick(ctx);
 }
 
 /**
  * Saves the Elements that are currently enabled so that they can be recovered after each complete symbol cycle.
  */
-void Automata::profileEnables() {
+void Automata::profileEnables(SimulationContext &ctx) {
 
     // clear data structures
-    while(!enabledLastCycle.empty()){
-        enabledLastCycle.pop();
+    while(!ctx.enabledLastCycle.empty()){
+        ctx.enabledLastCycle.pop();
     }
     
     // per element statistics
-    queue<Element*> tmp;
-    while(!enabledSTEs.empty()) {
+    queue<uint32_t> tmp;
+    while(!ctx.enabledSTEs.empty()) {
         
-        Element* s = enabledSTEs.back();
-        tmp.push(s);
-        enabledSTEs.pop_back();
+        uint32_t index = ctx.enabledSTEs.back();
+        Element* s = compiled->getSTEElement(index);
+        tmp.push(index);
+        ctx.enabledSTEs.pop_back();
         
         // track number of times each ste was enabled per step
-        enabledCount[s] = enabledCount[s] + 1;
+        ctx.enabledCount[s] = ctx.enabledCount[s] + 1;
         
         // track the STEs that were enabled on the last cycle
-        enabledLastCycle.push(s);
+        ctx.enabledLastCycle.push(s);
     }
     
     //push back onto queue to proceed to next stage
     while(!tmp.empty()) {
-        enabledSTEs.push_back(tmp.front());
+        ctx.enabledSTEs.push_back(tmp.front());
         tmp.pop();
     }
 }
@@ -740,44 +941,45 @@ void Automata::profileEnables() {
 /**
  * Saves the Elements that are currently activated so that they can be recovered after each complete symbol cycle.
  */
-void Automata::profileActivations() {
+void Automata::profileActivations(SimulationContext &ctx) {
 
     // clear data structures
-    while(!activatedLastCycle.empty()){
-        activatedLastCycle.pop();
+    while(!ctx.activatedLastCycle.empty()){
+        ctx.activatedLastCycle.pop();
     }
 
-    while(!reportedLastCycle.empty()){
-        reportedLastCycle.pop();
+    while(!ctx.reportedLastCycle.empty()){
+        ctx.reportedLastCycle.pop();
     }
     
     // Get per cycle stats
-    activatedHist.push_back(activatedSTEs.size());
+    ctx.activatedHist.push_back(ctx.activatedSTEs.size());
     
     // Get per STE stats
     // Check number of times each ste was activated per step
-    queue<STE*> tmp;
-    while(!activatedSTEs.empty()) {
+    queue<uint32_t> tmp;
+    while(!ctx.activatedSTEs.empty()) {
         
-        STE* s = activatedSTEs.back();
-        tmp.push(s);
-        activatedSTEs.pop_back();
+        uint32_t index = ctx.activatedSTEs.back();
+        STE* s = compiled->getSTEElement(index);
+        tmp.push(index);
+        ctx.activatedSTEs.pop_back();
         
         // track number of times each STE activated
-        activatedCount[s] = activatedCount[s] + 1;
+        ctx.activatedCount[s] = ctx.activatedCount[s] + 1;
         
         // track the STEs that activated on the last cycle
-        activatedLastCycle.push(s);
+        ctx.activatedLastCycle.push(s);
 
         // if any were reports, also track reports
         if(s->isReporting()){
-            reportedLastCycle.push(s);
+            ctx.reportedLastCycle.push(s);
         }
     }
     
     //push back onto queue to proceed to next stage
     while(!tmp.empty()) {
-        activatedSTEs.push_back(tmp.front());
+        ctx.activatedSTEs.push_back(tmp.front());
         tmp.pop();
     }        
 }
@@ -786,14 +988,33 @@ void Automata::profileActivations() {
  * Enables start states and primes simulation. Must be executed before simulation.
  */
 void Automata::initializeSimulation() {
+
+    initializeSimulation(true);
+}
+
+/**
+ * Enables start states and primes simulation. Start-of-data states are only enabled if enableStartOfData is set, e.g. when simulation starts mid-stream at a symbol that does not follow an end of data.
+ */
+void Automata::initializeSimulation(bool enableStartOfData) {
+
+    initializeSimulation(context, enableStartOfData);
+}
+
+/**
+ * Enables start states in the given simulation context and primes simulation.
+ */
+void Automata::initializeSimulation(SimulationContext &ctx, bool enableStartOfData) {
+
+    // recompile if the graph changed since the last compilation
+    if(compiled == NULL)
+        compileAutomata();
     
     // Initiate simulation by enabling all start states
-    bool enableStartOfDataStates = true;
-    enableStartStates(enableStartOfDataStates);
+    enableStartStates<SIM_DEBUG>(ctx, enableStartOfData);
 
     //
     if(profile)
-        profileEnables();
+        profileEnables(ctx);
     
 }
 
@@ -802,43 +1023,309 @@ void Automata::initializeSimulation() {
  */
 void Automata::simulate(uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t total_length) {
 
-    cycle = start_index;
+    simulate(context, inputs, start_index, length, total_length);
+}
+
+/**
+ * Simulates the automata on input string in the given simulation context. Starts at start_index and runs for length symbols.
+ */
+void Automata::simulate(SimulationContext &ctx, uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t total_length) {
+
+    ctx.cycle = start_index;
+    ctx.progress_length = length;
+
+    // primes all data structures for simulation; start-of-data states are
+    // only enabled at the start of the input or right after an end of data
+    initializeSimulation(ctx, start_index == 0 || inputs[start_index - 1] == (uint32_t)'\n');
+
+    // the last symbol of the input is end of data
+    simulateChunk(ctx, inputs + start_index, length, start_index + length == total_length);
+
+    finishProgress(length);
+ 
+    if(profile) {
+
+        cout << endl << "Dynamic Statistics: " << endl;
+
+        // cal average active set
+        uint64_t sum = 0;
+        for(uint32_t acts : ctx.activatedHist){
+            sum += (uint64_t)acts;
+        }
+
+        cout << "  Average Active Set: " << (double)sum / (double)length << endl;
+        for(uint32_t acts : ctx.activatedHist){
+            sum += (uint64_t)acts;
+        }
+
+        // cal distribution
 
-    // primes all data structures for simulation
-    initializeSimulation();
+        // build histogram of activations
+        buildActivationHistogram(ctx, "activation_hist.out");        
+        
+        // print activation stats
+        calcEnableDistribution(ctx);
+        
+        // write to file
+        writeIntVectorToFile(ctx.enabledHist, "enabled_per_cycle.out");
+        writeIntVectorToFile(ctx.activatedHist, "activated_per_cycle.out");
     
-    // for all inputs
-    for(uint64_t i = start_index; i < start_index + length; i = i + 1) {
+        cout << endl;
+    }
+}
+
+/**
+ * Continues simulation on the next length symbols of an input stream. All simulation state and the cycle counter carry over from the previous call, so an input may be simulated in any number of chunks. The last symbol of the chunk is end of data if end_of_input is set. initializeSimulation() must be called once before the first chunk. For STE-only automata without profiling or state dumping, stretches of input where no STE is enabled are skipped with the Prefilter; cycle numbers of reports are unaffected.
+ */
+void Automata::simulateChunk(uint8_t *inputs, uint64_t length, bool end_of_input) {
+
+    simulateChunk(context, inputs, length, end_of_input);
+}
+
+/**
+ * Continues simulation on the next length symbols of an input stream in the given simulation context.
+ */
+void Automata::simulateChunk(SimulationContext &ctx, uint8_t *inputs, uint64_t length, bool end_of_input) {
+
+    SimulationLoop loop = simulation_variants.loops[getSimulationFeatures()];
+    (this->*loop)(ctx, inputs, length, end_of_input);
+
+    // all reports of the chunk have been sent
+    if(report)
+        ctx.reportSink->advance(ctx.cycle);
+}
+
+/**
+ * Simulates several independent input streams in lockstep in one thread, each in its own context, one symbol of every stream per round. Large automata spend most of their time waiting for STE records and successor lists; the matches of all streams are computed before any of their children are enabled, and each phase prefetches what the other phase will read, so the memory accesses of one stream overlap with the work on the others. Each stream continues from its context like simulateChunk(). Automata with special elements, profiling or state dumping simulate the streams one after another instead.
+ */
+void Automata::simulateInterleaved(SimulationContext **ctxs, uint8_t **inputs, uint64_t *lengths, bool *end_of_input, uint32_t num_streams) {
+
+    uint32_t features = getSimulationFeatures();
+
+    if(features & (SIM_SPECELS | SIM_DEBUG)) {
+        for(uint32_t s = 0; s < num_streams; s++) {
+            simulateChunk(*ctxs[s], inputs[s], lengths[s], end_of_input[s]);
+        }
+        return;
+    }
+
+    // progress of several streams cannot be shown in one line
+    switch(features & (SIM_REPORT | SIM_EOD | SIM_SKIP_IDLE)) {
+    case 0:
+        simulateInterleavedLoop<SIM_PREFETCH>(ctxs, inputs, lengths, end_of_input, num_streams);
+        break;
+    case SIM_REPORT:
+        simulateInterleavedLoop<SIM_PREFETCH | SIM_REPORT>(ctxs, inputs, lengths, end_of_input, num_streams);
+        break;
+    case SIM_EOD:
+        simulateInterleavedLoop<SIM_PREFETCH | SIM_EOD>(ctxs, inputs, lengths, end_of_input, num_streams);
+        break;
+    case SIM_REPORT | SIM_EOD:
+        simulateInterleavedLoop<SIM_PREFETCH | SIM_REPORT | SIM_EOD>(ctxs, inputs, lengths, end_of_input, num_streams);
+        break;
+    case SIM_SKIP_IDLE:
+        simulateInterleavedLoop<SIM_PREFETCH | SIM_SKIP_IDLE>(ctxs, inputs, lengths, end_of_input, num_streams);
+        break;
+    case SIM_REPORT | SIM_SKIP_IDLE:
+        simulateInterleavedLoop<SIM_PREFETCH | SIM_REPORT | SIM_SKIP_IDLE>(ctxs, inputs, lengths, end_of_input, num_streams);
+        break;
+    case SIM_EOD | SIM_SKIP_IDLE:
+        simulateInterleavedLoop<SIM_PREFETCH | SIM_EOD | SIM_SKIP_IDLE>(ctxs, inputs, lengths, end_of_input, num_streams);
+        break;
+    default:
+        simulateInterleavedLoop<SIM_PREFETCH | SIM_REPORT | SIM_EOD | SIM_SKIP_IDLE>(ctxs, inputs, lengths, end_of_input, num_streams);
+        break;
+    }
+
+    // all reports of the chunks have been sent
+    if(report) {
+        for(uint32_t s = 0; s < num_streams; s++) {
+            ctxs[s]->reportSink->advance(ctxs[s]->cycle);
+        }
+    }
+}
+
+/**
+ * Interleaved simulation loop with the features F. Streams leave the round as soon as their input is used up.
+ */
+template<uint32_t F>
+void Automata::simulateInterleavedLoop(SimulationContext **ctxs, uint8_t **inputs, uint64_t *lengths, bool *end_of_input, uint32_t num_streams) {
+
+    // streams with input left and the position in each
+    vector<uint32_t> active;
+    vector<uint64_t> pos(num_streams, 0);
+    for(uint32_t s = 0; s < num_streams; s++) {
+        if(lengths[s] > 0)
+            active.push_back(s);
+    }
+
+    uint64_t round = 0;
+    while(!active.empty()) {
 
-        // set end of data flag if its the last byte
-        if( i == total_length - 1 ) {
-            setEndOfData(true);
-        }    
-        // set end of data flag if the byte is a "\n"
-        else if( inputs[i] == (uint32_t)'\n' ) {
-            setEndOfData(true);
+        // tell the report sinks how far we got
+        if((F & SIM_REPORT) && round++ % REPORT_SINK_ADVANCE_INTERVAL == 0) {
+            for(uint32_t s : active) {
+                ctxs[s]->reportSink->advance(ctxs[s]->cycle);
+            }
+        }
+
+        // match the next symbol of every stream
+        for(uint32_t k = 0; k < active.size(); ) {
+            uint32_t s = active[k];
+            SimulationContext &ctx = *ctxs[s];
+
+            // if no STE is enabled, jump to the next symbol that can activate a start state
+            if((F & SIM_SKIP_IDLE) && ctx.enabledSTEs.empty()) {
+                uint64_t next = prefilter->scan(inputs[s], pos[s], lengths[s]);
+                ctx.cycle += next - pos[s];
+                pos[s] = next;
+                if(next == lengths[s]) {
+                    active[k] = active.back();
+                    active.pop_back();
+                    continue;
+                }
+            }
+
+            uint8_t symbol = inputs[s][pos[s]];
+
+            // set end of data flag if its the last byte or a "\n"
+            if(F & SIM_EOD)
+                ctx.setEndOfData((end_of_input[s] && pos[s] == lengths[s] - 1) || symbol == (uint32_t)'\n');
+
+            computeSTEMatches<F>(ctx, symbol);
+            k++;
+        }
+
+        // enable the children of the matches of every stream
+        for(uint32_t k = 0; k < active.size(); ) {
+            uint32_t s = active[k];
+            SimulationContext &ctx = *ctxs[s];
+
+            enableSTEMatchingChildren<F>(ctx);
+            enableStartStates<F>(ctx, (F & SIM_EOD) && ctx.end_of_data);
+            tick(ctx);
+
+            if(++pos[s] == lengths[s]) {
+                active[k] = active.back();
+                active.pop_back();
+                continue;
+            }
+            k++;
         }
-        // unset end of data otherwise
-        else {
-            setEndOfData(false);
+    }
+}
+
+/**
+ * Simulation loop over length input symbols with the features F. Features that are not in F are compiled out, so the loop does not test them per symbol.
+ */
+template<uint32_t F>
+void Automata::simulateLoop(SimulationContext &ctx, uint8_t *inputs, uint64_t length, bool end_of_input) {
+
+    runLoop<F>(ctx, inputs, length, end_of_input, [this, &ctx](uint8_t symbol) {
+            simulateStep<F % SIM_NUM_STEP_VARIANTS>(ctx, symbol);
+        });
+}
+
+/**
+ * Feeds length input symbols to step, one cycle each, and takes care of everything around it: skipping idle input, advancing the report sink, the end of data flag and progress output. step must advance the cycle of ctx.
+ */
+template<uint32_t F, class Step>
+void Automata::runLoop(SimulationContext &ctx, uint8_t *inputs, uint64_t length, bool end_of_input, Step step) {
+
+    uint64_t next_advance = 0;
+
+    // for all inputs
+    for(uint64_t i = 0; i < length; i = i + 1) {
+
+        // if no STE is enabled, jump to the next symbol that can activate a start state
+        if((F & SIM_SKIP_IDLE) && ctx.enabledSTEs.empty()) {
+            uint64_t next = prefilter->scan(inputs, i, length);
+            ctx.cycle += next - i;
+            i = next;
+            if(i == length)
+                break;
+        }
+
+        // tell the report sink how far we got
+        if((F & SIM_REPORT) && i >= next_advance) {
+            ctx.reportSink->advance(ctx.cycle);
+            next_advance = i + REPORT_SINK_ADVANCE_INTERVAL;
         }
 
+        // set end of data flag if its the last byte or a "\n"
+        if(F & SIM_EOD)
+            ctx.setEndOfData((end_of_input && i == length - 1) || inputs[i] == (uint32_t)'\n');
+
         // measure progress on longer runs
-        if(!quiet) {
+        if(F & SIM_PROGRESS) {
 
-            if(i % 10000 == 0) {
-                if(i != 0) {
+            if(ctx.cycle % 10000 == 0) {
+                if(ctx.cycle != 0) {
                     cout << "\x1B[2K"; // Erase the entire current line.
                     cout << "\x1B[0E";  // Move to the beginning of the current line.
                 }
 
-                cout << "  Progress: " << i << " / " << length << "\r";
+                cout << "  Progress: " << ctx.cycle;
+                if(ctx.progress_length != 0)
+                    cout << " / " << ctx.progress_length;
+                cout << "\r";
                 flush(cout);
                 //
             }
         }
-        simulate(inputs[i]);
+        step(inputs[i]);
     }
+}
+
+/**
+ * Simulates length symbols starting at start_index with an alternative engine in the given context. The engine holds the STE state; the context holds the cycle, the end of data flag and the report sink. Start-of-data states are enabled under the same condition as in simulate(), and reports are only sent if reporting is enabled.
+ */
+template<class Engine>
+void Automata::simulateEngine(Engine *engine, SimulationContext &ctx, uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t total_length) {
+
+    ctx.cycle = start_index;
+    ctx.progress_length = length;
+
+    // primes the engine; start-of-data states are only enabled at the
+    // start of the input or right after an end of data
+    engine->enableStartStates(start_index == 0 || inputs[start_index - 1] == (uint32_t)'\n');
+
+    // a NULL sink drops the reports
+    ReportSink *sink = report ? ctx.reportSink : NULL;
+    auto step = [this, engine, &ctx, sink](uint8_t symbol) {
+        engine->simulate(symbol, ctx.end_of_data, ctx.cycle, sink);
+        tick(ctx);
+    };
+
+    // engines always track end of data; only reporting and progress vary
+    inputs += start_index;
+    bool end_of_input = (start_index + length == total_length);
+    switch(getSimulationFeatures() & (SIM_REPORT | SIM_PROGRESS)) {
+    case 0:
+        runLoop<SIM_EOD>(ctx, inputs, length, end_of_input, step);
+        break;
+    case SIM_REPORT:
+        runLoop<SIM_EOD | SIM_REPORT>(ctx, inputs, length, end_of_input, step);
+        break;
+    case SIM_PROGRESS:
+        runLoop<SIM_EOD | SIM_PROGRESS>(ctx, inputs, length, end_of_input, step);
+        break;
+    default:
+        runLoop<SIM_EOD | SIM_REPORT | SIM_PROGRESS>(ctx, inputs, length, end_of_input, step);
+        break;
+    }
+
+    // all reports have been sent
+    if(report)
+        ctx.reportSink->advance(ctx.cycle);
+
+    finishProgress(length);
+}
+
+/**
+ * Completes the progress line of a run over length symbols.
+ */
+void Automata::finishProgress(uint64_t length) {
 
     if(!quiet) {
         cout << "\x1B[2K"; // Erase the entire current line.
@@ -847,34 +1334,115 @@ void Automata::simulate(uint8_t *inputs, uint64_t start_index, uint64_t length,
         flush(cout);
         cout << endl;
     }
- 
-    if(profile) {
+}
 
-        cout << endl << "Dynamic Statistics: " << endl;
+/**
+ * Corrects a speculative simulation of the input slice [start_index, start_index + length) in ctx using previous, the context that really simulated the preceding slice. The speculative run started from the state a fresh simulation has at start_index, so it only differs from the true run until both runs reach the same state. Only that divergent prefix is simulated again, from the state of previous, next to a replay of the speculative run; the replay is needed to tell when the runs converge. The reports of the re-run replace the speculative reports of the prefix, so ctx holds exactly the reports of a single-threaded run, in the same order, and its true end state. ctx can then be passed as previous for the next slice.
+ */
+void Automata::reconcileSlice(SimulationContext &ctx, SimulationContext &previous, uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t total_length) {
+
+    if(compiled == NULL)
+        compileAutomata();
+
+    // replay of the speculative run
+    SimulationContext speculative(compiled);
+    speculative.cycle = start_index;
+    initializeSimulation(speculative, start_index == 0 || inputs[start_index - 1] == (uint32_t)'\n');
+
+    // true run from the state of the preceding slice
+    SimulationContext corrected(compiled);
+    corrected.copyState(previous);
+    corrected.cycle = start_index;
+
+    SimulationStep step = simulation_variants.steps[getSimulationFeatures() % SIM_NUM_STEP_VARIANTS];
+    uint64_t i = start_index;
+    bool converged = corrected.hasSameState(speculative);
+    while(!converged && i < start_index + length) {
+        bool eod = (i == total_length - 1 || inputs[i] == (uint32_t)'\n');
+        speculative.setEndOfData(eod);
+        corrected.setEndOfData(eod);
+        (this->*step)(speculative, inputs[i]);
+        (this->*step)(corrected, inputs[i]);
+        i++;
+        converged = corrected.hasSameState(speculative);
+    }
+
+    // speculative reports from cycle i on are already right
+    vector<Report> &reports = ctx.getReports();
+    vector<Report> &prefix = corrected.getReports();
+    auto rest = find_if(reports.begin(), reports.end(), [i](const Report &r) { return r.cycle >= i; });
+    prefix.insert(prefix.end(), rest, reports.end());
+    reports.swap(prefix);
+    ctx.reportVector.clear();
+    ctx.reportCodes.clear();
+
+    // the runs never met, so the speculative end state is wrong
+    if(!converged)
+        ctx.copyState(corrected);
+}
 
-        // cal average active set
-        uint64_t sum = 0;
-        for(uint32_t acts : activatedHist){
-            sum += (uint64_t)acts;
-        }
+/**
+ * Simulates the automata on input string using the bit-parallel engine. Starts at start_index and runs for length symbols. Produces the same reports in the same cycles as simulate(), but the reports of one cycle are sent in ascending compiled STE index order instead of the order the default engine activates the STEs in. Only supports STE-only automata; automata with special elements, profiling or state dumping fall back to simulate().
+ */
+void Automata::simulateBitParallel(uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t total_length) {
 
-        cout << "  Average Active Set: " << (double)sum / (double)length << endl;
-        for(uint32_t acts : activatedHist){
-            sum += (uint64_t)acts;
-        }
+    simulateBitParallel(context, inputs, start_index, length, total_length);
+}
 
-        // cal distribution
+/**
+ * Simulates the automata on input string using the bit-parallel engine in the given simulation context. The engine's STE state is shared by all contexts.
+ */
+void Automata::simulateBitParallel(SimulationContext &ctx, uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t total_length) {
 
-        // build histogram of activations
-        buildActivationHistogram("activation_hist.out");        
-        
-        // print activation stats
-        calcEnableDistribution();
-        
-        // write to file
-        writeIntVectorToFile(enabledHist, "enabled_per_cycle.out");
-        writeIntVectorToFile(activatedHist, "activated_per_cycle.out");
-    
+    if(specialElements.size() > 0 || profile || dump_state) {
+        if(!quiet)
+            cout << "VASim WARNING: Bit-parallel engine only supports STE-only automata without profiling. Falling back to default engine." << endl;
+        simulate(ctx, inputs, start_index, length, total_length);
+        return;
+    }
+
+    // build engine on first use
+    if(compiled == NULL)
+        compileAutomata();
+
+    if(bitParallelEngine == NULL)
+        bitParallelEngine = new BitParallelEngine(compiled.get());
+
+    simulateEngine(bitParallelEngine, ctx, inputs, start_index, length, total_length);
+}
+
+/**
+ * Simulates the automata on input string using the lazy DFA engine. Starts at start_index and runs for length symbols. DFA transitions are discovered and cached during simulation, and the cache persists across calls and reset() until the graph changes. Produces the same reports in the same cycles as simulate(), but the reports of one cycle are sent in ascending compiled STE index order instead of the order the default engine activates the STEs in. Only supports STE-only automata; automata with special elements or state dumping fall back to simulate(). Profiling prints cache statistics instead of per-element histograms.
+ */
+void Automata::simulateLazyDFA(uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t total_length) {
+
+    simulateLazyDFA(context, inputs, start_index, length, total_length);
+}
+
+/**
+ * Simulates the automata on input string using the lazy DFA engine in the given simulation context. The engine's DFA state and cache are shared by all contexts.
+ */
+void Automata::simulateLazyDFA(SimulationContext &ctx, uint8_t *inputs, uint64_t start_index, uint64_t length, uint64_t total_length) {
+
+    if(specialElements.size() > 0 || dump_state) {
+        if(!quiet)
+            cout << "VASim WARNING: Lazy DFA engine only supports STE-only automata without state dumping. Falling back to default engine." << endl;
+        simulate(ctx, inputs, start_index, length, total_length);
+        return;
+    }
+
+    // build engine on first use
+    if(compiled == NULL)
+        compileAutomata();
+
+    if(lazyDFAEngine == NULL)
+        lazyDFAEngine = new LazyDFAEngine(compiled.get(), lazyDFACacheSize);
+
+    simulateEngine(lazyDFAEngine, ctx, inputs, start_index, length, total_length);
+
+    if(profile) {
+        cout << endl << "Dynamic Statistics: " << endl;
+        lazyDFAEngine->printStatistics();
         cout << endl;
     }
 }
@@ -884,12 +1452,21 @@ void Automata::simulate(uint8_t *inputs, uint64_t start_index, uint64_t length,
  */
 void Automata::writeReportToFile(string fn) {
 
+    writeReportToFile(context, fn);
+}
+
+/**
+ * Writes the reports collected in the given simulation context to a file. Element ids and report codes are taken from the compiled report table of the context.
+ */
+void Automata::writeReportToFile(SimulationContext &ctx, string fn) {
+
+    vector<pair<uint64_t, string>> &reports = ctx.getReportVector();
+    vector<string> &codes = ctx.getReportCodes();
+
     std::ofstream out(fn);
-    string str;
-    for(pair<uint64_t,string> s : reportVector) {
-        str += to_string(s.first) + " : " + s.second + " : " + getElement(s.second)->getReportCode() + "\n";
+    for(uint64_t i = 0; i < reports.size(); i++) {
+        out << reports[i].first << " : " << reports[i].second << " : " << codes[i] << "\n";
     }
-    out << str;
     out.close();
 }
 
@@ -899,8 +1476,16 @@ void Automata::writeReportToFile(string fn) {
  */
 void Automata::printReportBatchSim() {
 
+    printReportBatchSim(context);
+}
+
+/**
+ * Prints the report vector of the given simulation context in the style of the Micron AP SDK batchSim automata simulator.
+ */
+void Automata::printReportBatchSim(SimulationContext &ctx) {
+
     // print report vector
-    for(auto s: reportVector) {
+    for(auto &s: ctx.getReportVector()) {
         uint64_t cycle = s.first + 1;
         if(id.empty()){
             cout << "Element id: " << s.second << " reporting at index " << to_string(cycle) << endl;
@@ -914,12 +1499,12 @@ void Automata::printReportBatchSim() {
 /**
  * Calculates proportions of elements that capture total amounts of automata activity. Prints automata proportions to stdout.
  */
-void Automata::calcEnableDistribution() {
+void Automata::calcEnableDistribution(SimulationContext &ctx) {
     
     // gather enables into vector
     vector<uint32_t> enables;
     uint64_t sum = 0;
-    for(auto e : enabledCount){
+    for(auto e : ctx.enabledCount){
         enables.push_back(e.second);
         sum += e.second;
     }
@@ -982,7 +1567,7 @@ void Automata::calcEnableDistribution() {
  */
 unordered_map<Element*, uint32_t> &Automata::getEnabledCount() {
 
-    return enabledCount;
+    return context.enabledCount;
 }
 
 /**
@@ -990,39 +1575,39 @@ unordered_map<Element*, uint32_t> &Automata::getEnabledCount() {
  */
 unordered_map<Element*, uint32_t> &Automata::getActivatedCount() {
 
-    return activatedCount;
+    return context.activatedCount;
 }
 
 /**
  * Constructs a histogram counting how many times each element in the automata was activated. Writes the histogram out to file.
  */
-void Automata::buildActivationHistogram(string fn) {
+void Automata::buildActivationHistogram(SimulationContext &ctx, string fn) {
 
-    maxActivations = 0;
+    ctx.maxActivations = 0;
 
     // gather histogram
-    for(auto s: activationVector) {
+    for(auto s: ctx.activationVector) {
         list<string> l = s.second;
         //cout << s.first << "::" << endl;
         for(auto e: l) {
-            activationHist[e]++;
+            ctx.activationHist[e]++;
             // keep track of the maximum number of activations
-            if(activationHist[e] > maxActivations)
-                maxActivations = activationHist[e];
+            if(ctx.activationHist[e] > ctx.maxActivations)
+                ctx.maxActivations = ctx.activationHist[e];
         }
     }
 
-    writeStringToFile(activationHistogramToString(), fn);
+    writeStringToFile(activationHistogramToString(ctx), fn);
 }
 
 
 /**
  * Writes the activation histogram to a string.
  */
-string Automata::activationHistogramToString() {
+string Automata::activationHistogramToString(SimulationContext &ctx) {
 
     string str = "";
-    for(auto s: activationHist) {
+    for(auto s: ctx.activationHist) {
         str += s.first + "\t" + to_string(s.second) + "\n";
     }
 
@@ -1036,13 +1621,13 @@ string Automata::activationHistogramToString() {
 string Automata::getElementColor(string id) {
 
     // get hit count
-    uint32_t hits = activationHist[id];
+    uint32_t hits = context.activationHist[id];
 
-    double ratio = (double)hits/(double)maxActivations;
+    double ratio = (double)hits/(double)context.maxActivations;
 
     int red, green, blue;
 
-    int scale = (int)((double)hits/(double)maxActivations * 511); 
+    int scale = (int)((double)hits/(double)context.maxActivations * 511); 
 
     if(scale > 255) {
         red = 255;
@@ -1103,9 +1688,9 @@ string Automata::getElementColor(string id) {
 string Automata::getElementColorLog(string id) {
 
     // get hit count
-    uint32_t hits = activationHist[id];
+    uint32_t hits = context.activationHist[id];
 
-    double ratio = (double)hits/(double)maxActivations;
+    double ratio = (double)hits/(double)context.maxActivations;
 
     int red, green, blue;
 
@@ -1165,9 +1750,9 @@ string Automata::getElementColorLog(string id) {
 string Automata::getLogElementColor(string id) {
 
     // get hit count
-    uint32_t hits = activationHist[id];
+    uint32_t hits = context.activationHist[id];
 
-    double ratio = (double)hits/(double)maxActivations;
+    double ratio = (double)hits/(double)context.maxActivations;
 
     int red, green, blue;
 
@@ -1325,8 +1910,10 @@ uint32_t Automata::removeOrGates() {
         }
 
         // add edges between all parents and children
-        for(string output : or_gate->getOutputs()){
-            for(auto input : or_gate->getInputs()){
+        vector<string> outputs = or_gate->getOutputs();
+        map<string, bool> inputs = or_gate->getInputs();
+        for(string output : outputs){
+            for(auto input : inputs){
                 addEdge(input.first, output);
             }
         }
@@ -1391,7 +1978,8 @@ void Automata::replaceCounters() {
 
         // for the guaranteed one STE on the count input
         STE *input;
-        for(auto in : counter->getInputs()){
+        map<string, bool> inputs = counter->getInputs();
+        for(auto in : inputs){
             input = static_cast<STE*>(getElement(in.first));
 
             // remove output to counter
@@ -1697,6 +2285,118 @@ void Automata::automataToMNRLFile(string out_fn) {
     
 }
 
+/**
+ * Appends str to the string pool of a binary automata file and returns its location.
+ */
+static BinaryString appendBinaryString(string &pool, const string &str) {
+
+    BinaryString location;
+    location.offset = pool.size();
+    location.length = str.size();
+    pool += str;
+
+    return location;
+}
+
+/**
+ * Writes automata to a binary automata file that can be loaded without parsing. See binaryAutomataParser.h for the format.
+ */
+void Automata::automataToBinaryFile(string out_fn) {
+
+    // sort elements by ID so output is deterministic
+    vector< pair<string, Element *>> els;
+    for(auto el : elements) {
+        els.push_back(el);
+    }
+    sort(els.begin(), els.end());
+
+    unordered_map<Element *, uint32_t> index;
+    for(uint32_t i = 0; i < els.size(); i++) {
+        index[els[i].second] = i;
+    }
+
+    vector<BinaryElement> records(els.size());
+    vector<BinaryEdge> edges;
+    string pool;
+
+    for(uint32_t i = 0; i < els.size(); i++) {
+
+        Element *el = els[i].second;
+        BinaryElement &r = records[i];
+        memset(&r, 0, sizeof(BinaryElement));
+
+        r.type = el->getType();
+        r.id = appendBinaryString(pool, el->getId());
+
+        if(el->isReporting()) {
+            r.flags |= BE_REPORTING;
+            r.report_code = appendBinaryString(pool, el->getReportCode());
+        }
+
+        if(el->isEod())
+            r.flags |= BE_EOD;
+
+        if(!el->isSpecialElement()) {
+            STE *ste = static_cast<STE*>(el);
+            bitset<256> column = ste->getBitColumn();
+            for(uint32_t symbol = 0; symbol < 256; symbol++) {
+                if(column.test(symbol))
+                    r.column[symbol >> 6] |= 1ULL << (symbol & 63);
+            }
+            r.symbol_set = appendBinaryString(pool, ste->getSymbolSet());
+            if(ste->startIsStartOfData())
+                r.flags |= BE_START_OF_DATA;
+            else if(ste->startIsAllInput())
+                r.flags |= BE_ALL_INPUT;
+        } else if(el->getType() == COUNTER_T) {
+            Counter *counter = static_cast<Counter*>(el);
+            r.target = counter->getTarget();
+            if(counter->getMode().compare("latch") == 0)
+                r.flags |= BE_COUNTER_LATCH;
+            else if(counter->getMode().compare("roll") == 0)
+                r.flags |= BE_COUNTER_ROLL;
+        }
+
+        // outputs of the form "childId[:port]"
+        r.edges_begin = edges.size();
+        for(string output : el->getOutputs()) {
+            BinaryEdge edge;
+            edge.to = index[getElement(output)];
+            edge.port = appendBinaryString(pool, Element::getPort(output));
+            edges.push_back(edge);
+        }
+        r.edges_end = edges.size();
+    }
+
+    // lay out 8 byte aligned sections
+    BinaryAutomataHeader header;
+    memset(&header, 0, sizeof(BinaryAutomataHeader));
+    memcpy(header.magic, BINARY_AUTOMATA_MAGIC, sizeof(header.magic));
+    header.version = BINARY_AUTOMATA_VERSION;
+    header.byte_order = BINARY_AUTOMATA_BYTE_ORDER;
+    header.num_elements = records.size();
+    header.num_edges = edges.size();
+    header.id = appendBinaryString(pool, id);
+    header.elements_offset = (sizeof(BinaryAutomataHeader) + 7) & ~7ULL;
+    header.edges_offset = (header.elements_offset + records.size() * sizeof(BinaryElement) + 7) & ~7ULL;
+    header.strings_offset = (header.edges_offset + edges.size() * sizeof(BinaryEdge) + 7) & ~7ULL;
+    header.strings_size = pool.size();
+    header.file_size = header.strings_offset + header.strings_size;
+
+    string image(header.file_size, '\0');
+    memcpy(&image[0], &header, sizeof(BinaryAutomataHeader));
+    if(!records.empty())
+        memcpy(&image[header.elements_offset], records.data(), records.size() * sizeof(BinaryElement));
+    if(!edges.empty())
+        memcpy(&image[header.edges_offset], edges.data(), edges.size() * sizeof(BinaryEdge));
+    if(!pool.empty())
+        memcpy(&image[header.strings_offset], pool.data(), pool.size());
+
+    std::ofstream out(out_fn, std::ios::binary);
+    out.write(image.data(), image.size());
+    out.close();
+}
+
 /**
  * Outputs automata to Verilog HDL description following the algorithm originally developed by Xiaoping Huang and Mohamed El-Hadedy.
  */
@@ -2106,6 +2806,8 @@ void Automata::automataToGraphFile(string out_fn) {
  */
 void Automata::convertAllInputStarts() {
 
+    invalidateCompiledAutomata();
+
     // create new star ste start state
     STE *star_start = new STE("STAR_START", "*", "start-of-data");
     rawAddSTE(star_start);
@@ -2128,77 +2830,99 @@ void Automata::convertAllInputStarts() {
     }
 }
 
-/*
- *
- */
-inline bool set_comp(set<STE*>* lhs, set<STE*>* rhs) {
-
-    return (*lhs < *rhs);
-}
-
-/*
- * return true if lhs is strictly before rhs
+/**
+ * Splits the 256 input symbols into classes of symbols that no STE of compiled tells apart, so every STE matches either all or none of the symbols of a class. Writes the class of every symbol to classes and returns the number of classes. Classes are numbered by their smallest symbol.
  */
-inline bool state_comp(pair<set<STE*>*, STE*> lhs, pair<set<STE*>*, STE*> rhs) {
-
-    // if the sets are not the same, return the difference
-    if(*(lhs.first) != *(rhs.first))
-        return (*(lhs.first) < *(rhs.first));
-
-    // if the sets are the same, compare the bitsets
-    bitset<256> lhs_column = lhs.second->getBitColumn();
-    bitset<256> rhs_column = rhs.second->getBitColumn();
+static uint32_t computeSymbolClasses(const CompiledAutomata *compiled, uint8_t *classes) {
+
+    // only distinct columns refine the classes
+    vector<array<uint64_t, 4>> columns;
+    columns.reserve(compiled->getNumSTEs());
+    for(uint32_t i = 0; i < compiled->getNumSTEs(); i++) {
+        const uint64_t *c = compiled->getSTE(i).column;
+        columns.push_back({{c[0], c[1], c[2], c[3]}});
+    }
+    sort(columns.begin(), columns.end());
+    columns.erase(unique(columns.begin(), columns.end()), columns.end());
+
+    // split every class by whether each column matches its symbols
+    uint32_t num_classes = 1;
+    fill(classes, classes + 256, 0);
+    vector<int32_t> split(512);
+    for(const array<uint64_t, 4> &column : columns) {
+
+        fill(split.begin(), split.end(), -1);
+        uint32_t next = 0;
+        for(uint32_t symbol = 0; symbol < 256; symbol++) {
+            uint32_t key = classes[symbol] * 2 + ((column[symbol >> 6] >> (symbol & 63)) & 1);
+            if(split[key] < 0)
+                split[key] = next++;
+            classes[symbol] = split[key];
+        }
 
-    for(uint32_t i = 0; i < 256; i++){
-        if(lhs_column[i] == false &&  rhs_column[i] == true)
-            return true;
-        if(lhs_column[i] == true && rhs_column[i] == false)
-            return false;
+        num_classes = next;
+        if(num_classes == 256)
+            break;
     }
 
-    // if they're equal, return false
-    return false;
+    return num_classes;
 }
 
-
 /**
- * Returns the set of STEs reachable from the input set of STEs on this input symbol.
+ * Returns all STEs ordered by a breadth first search from the start states. Children are placed near their parents, which keeps index-based engines cache friendly. STEs unreachable from a start state are appended in ID order.
  */
-set<STE*>* Automata::follow(uint32_t symbol, set<STE*>* state_set) {
+vector<STE*> Automata::orderSTEsBreadthFirst() {
+
+    vector<STE*> ordered;
 
+    unmarkAllElements();
 
-    set<STE*>* follow_set = new set<STE*>;
+    // visit starts in ID order so the result is deterministic
+    vector<STE*> sorted_starts(starts);
+    sort(sorted_starts.begin(), sorted_starts.end(),
+         [](STE *a, STE *b) { return a->getId() < b->getId(); });
 
-    // for each start
-    for(STE *start : getStarts()){
-        if(start->match((uint8_t)symbol)){
-            // add to follow_set
-            //cout << start->getId() << " matched on input " << endl; 
-            follow_set->insert(start);
+    queue<STE*> workq;
+    for(STE *s : sorted_starts) {
+        if(!s->isMarked()) {
+            s->mark();
+            workq.push(s);
         }
     }
-    
-    // for each STE in the set
-    for(STE *ste : *state_set){
-        // for each child
-        for(auto e : ste->getOutputSTEPointers()){
-            STE * child = static_cast<STE*>(e.first);
-            // if they match this character
-            if(child->match((uint8_t)symbol)){
-                // add to follow_set
-                follow_set->insert(child);
+
+    while(!workq.empty()) {
+        STE *s = workq.front();
+        workq.pop();
+        ordered.push_back(s);
+
+        for(auto e : s->getOutputSTEPointers()) {
+            STE *child = static_cast<STE*>(e.first);
+            if(!child->isMarked()) {
+                child->mark();
+                workq.push(child);
             }
         }
     }
 
-    return follow_set;
-}
+    // append any STE only reachable through special elements
+    vector<STE*> rest;
+    for(auto e : elements) {
+        if(!e.second->isSpecialElement() && !e.second->isMarked())
+            rest.push_back(static_cast<STE*>(e.second));
+    }
+    sort(rest.begin(), rest.end(),
+         [](STE *a, STE *b) { return a->getId() < b->getId(); });
+    ordered.insert(ordered.end(), rest.begin(), rest.end());
+
+    unmarkAllElements();
 
+    return ordered;
+}
 
 /**
- * Constructs an equivalent homogeneous DFA from the current automata. This algorithm is worst case exponential in space and time and so may not be feasible for even medium-sized automata.
+ * Constructs an equivalent homogeneous DFA from the current automata by subset construction. Every DFA state is a hash-consed sorted set of compiled STE indices together with the symbols it is entered on, and transitions are computed once per symbol class (see computeSymbolClasses()) instead of once per symbol. Only STEs are considered. This algorithm is worst case exponential in space and time, so it gives up and returns NULL once the DFA has more than max_states states.
  */
-Automata* Automata::generateDFA() {
+Automata* Automata::generateDFA(uint32_t max_states) {
 
     if(!quiet)
         cout << "Generating DFA..." << endl;
@@ -2208,419 +2932,507 @@ Automata* Automata::generateDFA() {
     //  keep the automata going
     //convertAllInputStarts();
 
-    Automata* dfa = new Automata();
-    //
-    bool(*fn_pt)(set<STE*>*, set<STE*>*) = set_comp; //custom comparison method for set
-    //
-    bool(*fn_pt2)(pair<set<STE*>*, STE*>, pair<set<STE*>*, STE*>) = state_comp; //custom comparison method for set
+    const CompiledAutomata *nfa = getCompiledAutomata();
+    uint32_t num_stes = nfa->getNumSTEs();
+
+    // symbol classes and the symbols of each class
+    uint8_t classes[256];
+    uint32_t num_classes = computeSymbolClasses(nfa, classes);
+    vector<bitset<256>> class_symbols(num_classes);
+    vector<uint8_t> class_symbol(num_classes);
+    for(int32_t symbol = 255; symbol >= 0; symbol--) {
+        class_symbols[classes[symbol]].set(symbol);
+        class_symbol[classes[symbol]] = symbol;
+    }
+
+    // classes matched by every STE, as a CSR array
+    vector<uint32_t> ste_classes_offsets(num_stes + 1, 0);
+    vector<uint32_t> ste_classes;
+    for(uint32_t i = 0; i < num_stes; i++) {
+        for(uint32_t k = 0; k < num_classes; k++) {
+            if(nfa->getSTE(i).match(class_symbol[k]))
+                ste_classes.push_back(k);
+        }
+        ste_classes_offsets[i + 1] = ste_classes.size();
+    }
+
+    // every start is entered again on each symbol it matches
+    vector<vector<uint32_t>> class_starts(num_classes);
+    for(uint32_t start : nfa->getStarts()) {
+        for(uint32_t e = ste_classes_offsets[start]; e < ste_classes_offsets[start + 1]; e++)
+            class_starts[ste_classes[e]].push_back(start);
+    }
 
-    // global data structure to hold DFA states (used for searching for uniqueness)
-    set<pair<set<STE*>*, STE*>, bool(*)(pair<set<STE*>*,STE*>, pair<set<STE*>*,STE*>)> dfa_states (fn_pt2);
+    // hash-consed NFA state sets; whether any of their STEs reports
+    unordered_map<vector<uint32_t>, uint32_t, STESetHash> set_ids;
+    vector<const vector<uint32_t> *> sets;
+    vector<uint8_t> set_reporting;
 
-    // counter for dfa integer IDs
+    // DFA STEs entered into each set, one per distinct symbol set
+    vector<vector<pair<bitset<256>, STE*>>> set_states;
+
+    auto internSet = [&](const vector<uint32_t> &set) -> uint32_t {
+        auto got = set_ids.find(set);
+        if(got != set_ids.end())
+            return got->second;
+
+        uint32_t id = sets.size();
+        got = set_ids.insert(make_pair(set, id)).first;
+        sets.push_back(&got->first);
+
+        bool reporting = false;
+        for(uint32_t i : set)
+            reporting |= (nfa->getSTE(i).flags & CSTE_REPORTING) != 0;
+        set_reporting.push_back(reporting);
+        set_states.push_back(vector<pair<bitset<256>, STE*>>());
+
+        return id;
+    };
+
+    Automata* dfa = new Automata();
     uint32_t dfa_state_ids = 0;
 
-    // map DFA state ID to STE in dfa
-    unordered_map<uint32_t, STE*> dfa_ste_map;
+    // work queue of (NFA state set, DFA STE) for subset construction alg
+    queue<pair<uint32_t, STE*>> workq;
 
-    // work queues for subset construction alg
-    queue<pair<set<STE*>*, STE*>> workq;
-    queue<pair<set<STE*>*, STE*>> next_workq;
+    // start at the implicit failure state
+    workq.push(make_pair(internSet(vector<uint32_t>()), (STE*)NULL));
 
-    // initialize failure state
-    set<STE*>* start_state = new set<STE*>;
-    
-    // push impl start onto workq
-    workq.push(make_pair(start_state, (STE*)NULL));
+    // scratch space
+    vector<uint32_t> mark(num_stes, 0);
+    uint32_t stamp = 0;
+    vector<uint32_t> children;
+    vector<vector<uint32_t>> follow(num_classes);
+    vector<uint32_t> class_set(num_classes);
+    vector<uint32_t> group_mark;
+    vector<uint32_t> groups;
+    vector<bitset<256>> group_symbols;
 
-    uint32_t dfa_state_counter = 0;
-    
     // main loop
     while(!workq.empty()){
 
-        if(!quiet)
-            cout << "DFA States:" <<  dfa_state_counter << " -- Stack:" << workq.size() << endl;
-
         // get current working DFA state set and STE
-        set<STE*>* dfa_state = workq.front().first;
+        uint32_t dfa_state = workq.front().first;
         STE* dfa_ste = workq.front().second;
         workq.pop();
-        dfa_state_counter++;
 
-        //
-        // find unique next DFA states for each character class
-        //
+        // distinct children of the set
+        stamp++;
+        children.clear();
+        for(uint32_t i : *sets[dfa_state]) {
+            const CompiledSTE &ste = nfa->getSTE(i);
+            for(uint32_t e = ste.succ_begin; e < ste.succ_end; e++) {
+                uint32_t child = nfa->getSuccessors()[e];
+                if(mark[child] != stamp) {
+                    mark[child] = stamp;
+                    children.push_back(child);
+                }
+            }
+        }
 
-        // holds all potential DFA states from this node
-        set<set<STE*>*, bool(*)(set<STE*>*, set<STE*>*)> potential_dfa_states (fn_pt);
-        // maps sets to STEs
-        unordered_map<set<STE*>*, STE*> ste_table;
-        
-        // for each character
-        for(uint32_t i = 0; i < 256; i++){
-            
-            //get the follow state
-            set<STE*>* potential_dfa_state = follow(i, dfa_state);
+        // follow set of every symbol class
+        for(uint32_t k = 0; k < num_classes; k++)
+            follow[k] = class_starts[k];
 
-            bool found = false;          
-            uint32_t unique_state_id = 0;
-            
-            // look through all existing potential DFA states
-            // is this potential DFA state unique?
-            set<set<STE*>*>::const_iterator got;
-            got = potential_dfa_states.find(potential_dfa_state);
-            if(got != potential_dfa_states.end()){
-                found = true;
-            }
-        
-            // if DFA state is unique
-            if(!found){
-                //cout << "found unique!" << endl;
-
-                // create new ste
-                STE * new_dfa_ste = new STE("temp", "","");
-                // add this character to its symbol set
-                new_dfa_ste->addSymbolToSymbolSet(i);
-                // if any of the sets STEs were reporting, set us to reporting
-                for(STE * nfa_state : *potential_dfa_state){
-                    if(nfa_state->isReporting()){
-                        new_dfa_ste->setReporting(true);
-                        break;
-                    }
-                }
+        for(uint32_t child : children) {
+            for(uint32_t e = ste_classes_offsets[child]; e < ste_classes_offsets[child + 1]; e++)
+                follow[ste_classes[e]].push_back(child);
+        }
 
-                // if we come from the first implicit state make us a start state
-                if(dfa_ste == NULL){
-                    new_dfa_ste->setStart("start-of-data");
-                }
+        // group classes with the same follow set, in class order
+        groups.clear();
+        for(uint32_t k = 0; k < num_classes; k++) {
+            sort(follow[k].begin(), follow[k].end());
+            follow[k].erase(unique(follow[k].begin(), follow[k].end()), follow[k].end());
 
-                // add dfa_state set to temp data structure
-                potential_dfa_states.insert(potential_dfa_state);
-                ste_table[potential_dfa_state] = new_dfa_ste;
+            uint32_t set = internSet(follow[k]);
+            if(group_mark.size() <= set) {
+                group_mark.resize(set + 1, 0);
+                group_symbols.resize(set + 1);
+            }
 
-            }else{
-                
-                // we already created this potential DFA state so retrieve it
-                STE* existing_dfa_ste = ste_table[(*got)];
+            if(group_mark[set] != stamp) {
+                group_mark[set] = stamp;
+                group_symbols[set].reset();
+                groups.push_back(set);
+            }
+            group_symbols[set] |= class_symbols[k];
+        }
 
-                // add new symbol to its charset (idempotent)
-                existing_dfa_ste->addSymbolToSymbolSet(i);
-            
-                // delete the potential object
-                delete potential_dfa_state;
-                
-            }            
-            
-        } // character for loop
+        // each group enters one DFA state, which may already exist
+        for(uint32_t set : groups) {
 
-        // once we have constructed the potential new DFA states
-        //  we must check if they already exist in the global DFA data struct
-        //  this includes comparing NFA states, and also character set of DFA STE
-        for(set<STE*>* potential_dfa_state : potential_dfa_states){
-            
-            // see if we exist in the global dfa states set
-            set<pair<set<STE*>*, STE*>>::const_iterator got2;
-            STE * potential_ste = ste_table[potential_dfa_state];
-            pair<set<STE*>*, STE*> potential_pair = make_pair(potential_dfa_state, potential_ste);
-            got2 = dfa_states.find(potential_pair);
-            STE * existing_dfa_ste;
-            bool found = false;
-            if(got2 != dfa_states.end()){
-                found = true;
-                existing_dfa_ste = (*got2).second;
-            }else{
-                existing_dfa_ste = potential_ste;
+            STE *next_ste = NULL;
+            for(auto &state : set_states[set]) {
+                if(state.first == group_symbols[set]) {
+                    next_ste = state.second;
+                    break;
+                }
             }
 
             // if we found a unique new state
-            if(!found){
-                // add it to the global state structure
-                dfa_states.insert(potential_pair);
-                // give STE unique ID
-                existing_dfa_ste->setId(to_string(dfa_state_ids));
-                existing_dfa_ste->setIntId(dfa_state_ids);
+            if(next_ste == NULL) {
+
+                if(dfa_state_ids == max_states) {
+                    for(auto e : dfa->getElements())
+                        delete e.second;
+                    delete dfa;
+                    return NULL;
+                }
+
+                // if we come from the first implicit state make us a start state
+                next_ste = new STE(to_string(dfa_state_ids),
+                                   "",
+                                   group_symbols[set],
+                                   (dfa_ste == NULL) ? "start-of-data" : "none");
+                next_ste->setSymbolSet(bitsetToCharset(group_symbols[set]));
+                next_ste->setIntId(dfa_state_ids);
+                next_ste->setReporting(set_reporting[set]);
                 dfa_state_ids++;
-                // add STE to the dfa
-                dfa->rawAddSTE(existing_dfa_ste);
-                // push it onto the workq for processing
-                next_workq.push(potential_pair);
+
+                dfa->rawAddSTE(next_ste);
+                set_states[set].push_back(make_pair(group_symbols[set], next_ste));
+                workq.push(make_pair(set, next_ste));
             }
 
             //add physical edge from current DFA state to new DFA state
             if(dfa_ste != NULL){
-                dfa_ste->addOutput(existing_dfa_ste->getId());
-                dfa_ste->addOutputPointer(make_pair(existing_dfa_ste, existing_dfa_ste->getId()));
-                existing_dfa_ste->addInput(dfa_ste->getId());
+                dfa_ste->addOutput(next_ste->getId());
+                dfa_ste->addOutputPointer(make_pair(next_ste, next_ste->getId()));
+                next_ste->addInput(dfa_ste->getId());
             }
+        }
+    }
+
+    if(!quiet)
+        cout << "  Generated " << dfa_state_ids << " DFA states from " << sets.size() << " NFA state sets and " << num_classes << " symbol classes" << endl;
+
+    return dfa;
+}
+
+
+/**
+ * Enable all elements that are start states. Start states initiate computation by being enabled on the first cycle (for start-of-data type) or every cycle (for all-input type). All-input starts are implicitly enabled on every cycle and are activated directly by computeSTEMatches() through a per-symbol dispatch table. They are only pushed onto the enabled stack together with the start-of-data starts, so they keep their place in the activation order, or when profiling needs to count them.
+ */
+template<uint32_t F>
+void Automata::enableStartStates(SimulationContext &ctx, bool enableStartOfData) {
+
+    bool countAllInput = (F & SIM_DEBUG) && profile;
+    if(enableStartOfData || countAllInput) {
+
+        //for each start element
+        for(uint32_t index : compiled->getStarts()) {
 
+            uint32_t flags = compiled->getSTE(index).flags;
+
+            // add to enabled queue if we were not already enabled
+            if(((flags & CSTE_ALL_INPUT) || (enableStartOfData && (flags & CSTE_START_OF_DATA))) &&
+               !ctx.steEnabled[index]) {
+                ctx.steEnabled[index] = 1;
+                ctx.enabledSTEs.push_back(index);
+            }
         }
+    }
+
+    // STEs enabled after this point are matched before the start states
+    ctx.startStatesTop = ctx.enabledSTEs.size();
+}
+
+/**
+ * Records an activation of the STE at index. If the STE is a report STE, record a report in the report vector.
+ */
+template<uint32_t F>
+inline void Automata::activateSTE(SimulationContext &ctx, uint32_t index, const CompiledSTE &s) {
+
+    // activate
+    ctx.activatedSTEs.push_back(index);
+
+    // the successor list is read when the children are enabled
+    if(F & SIM_PREFETCH)
+        __builtin_prefetch(compiled->getSuccessors() + s.succ_begin);
 
+    if((F & SIM_DEBUG) && profile)
+        ctx.activationVector[ctx.cycle].push_back(compiled->getSTEElement(index)->getId());
 
-        // push next workq into workq
-        while(!next_workq.empty()){
-            workq.push(next_workq.front());
-            next_workq.pop();
+    // report; without SIM_EOD there are no eod STEs
+    if((F & SIM_REPORT) && (s.flags & CSTE_REPORTING)) {
+        if((F & SIM_EOD) && (s.flags & CSTE_EOD)) {
+            if(ctx.end_of_data)
+                ctx.reportSink->report(ctx.cycle, index);
+        }else{
+            ctx.reportSink->report(ctx.cycle, index);
         }
-
     }
-
-    return dfa;
- 
 }
 
-
 /**
- * Enable all elements that are start states. Start states initiate computation by being enabled on the first cycle (for start-of-data type) or every cycle (for all-input type).
+ * If an STE is enabled and matches on the current input, activate. All-input start STEs that match the input are activated from the per-symbol start dispatch table unless they were also explicitly enabled. STEs are activated in the same order as if all-input starts were pushed onto the enabled stack every cycle: STEs enabled after the start states first, then the start states, then the children enabled in the last cycle.
  */
-void Automata::enableStartStates(bool enableStartOfData) {
+template<uint32_t F>
+void Automata::computeSTEMatches(SimulationContext &ctx, uint8_t symbol) {
 
-    //for each start element
-    for(STE * s: starts) {
+    // STEs enabled after the start states, usually by special elements
+    while(ctx.enabledSTEs.size() > ctx.startStatesTop) {
 
-        // Enable if start is "all input"
-        if(s->startIsAllInput() || (enableStartOfData && s->startIsStartOfData())) { 
-           
-            // add to enabled queue if we were not already enabled
-            if(!s->isEnabled()){
-                s->enable();
-                enabledSTEs.push_back(static_cast<Element *>(s));
-            }
-        }
+        uint32_t index = ctx.enabledSTEs.back();
+        const CompiledSTE &s = compiled->getSTE(index);
+
+        // all-input starts are matched with the other start states below
+        if(!(s.flags & CSTE_ALL_INPUT) && s.match(symbol))
+            activateSTE<F>(ctx, index, s);
+
+        ctx.steEnabled[index] = 0;
+        ctx.enabledSTEs.pop_back();
     }
 
-}
+    // all-input starts that can match this symbol, last start first
+    const uint32_t *begin = compiled->getAllInputStartsBegin(symbol);
+    for(const uint32_t *start = compiled->getAllInputStartsEnd(symbol); start != begin; ) {
 
-/**
- * If an STE is enabled and matches on the current input, activate. If the STE is a report STE, record a report in the report vector. 
- */
-void Automata::computeSTEMatches(uint8_t symbol) {
+        start--;
+
+        // explicitly enabled starts are handled with the enabled stack
+        if(!ctx.steEnabled[*start])
+            activateSTE<F>(ctx, *start, compiled->getSTE(*start));
+    }
 
     //for each enabled ste
-    while(!enabledSTEs.empty()) {
+    while(!ctx.enabledSTEs.empty()) {
 
-        STE * s = static_cast<STE *>(enabledSTEs.back());
+        uint32_t index = ctx.enabledSTEs.back();
+        const CompiledSTE &s = compiled->getSTE(index);
 
         // if we match on the input character
         // the STE will activate and we record this
         // ste should also report
-        if(s->match(symbol)) {
-
-            //activate and push to queue only if we werent already
-            if(!s->isActivated()) {
-                s->activate();
-                activatedSTEs.push_back(s);
-            }
-
-            if(profile)
-                activationVector[cycle].push_back(s->getId());
-
-            // report
-            if(report && s->isReporting()) {
-                if(s->isEod()) {
-                    if(end_of_data)
-                        reportVector.push_back(make_pair(cycle, s->getId()));
-                }else{
-                    reportVector.push_back(make_pair(cycle, s->getId()));
-                }
-            }
-
+        if(s.match(symbol)) {
+            activateSTE<F>(ctx, index, s);
         }
 
         //disable 
-        s->disable();
+        ctx.steEnabled[index] = 0;
 
         // remove STE from the queue
-        enabledSTEs.pop_back();        
+        ctx.enabledSTEs.pop_back();        
     }
 }
 
 /**
  * Propagate activation signal of STEs that match on the current input symbol. Enables Element children of active STEs.
  */
-void Automata::enableSTEMatchingChildren() {
+template<uint32_t F>
+void Automata::enableSTEMatchingChildren(SimulationContext &ctx) {
+
+    const uint32_t *successors = compiled->getSuccessors();
 
     //for each activated ste
-    while(!activatedSTEs.empty()) {
+    while(!ctx.activatedSTEs.empty()) {
 
-        STE *s = activatedSTEs.back();
+        uint32_t index = ctx.activatedSTEs.back();
+        const CompiledSTE &s = compiled->getSTE(index);
         // remove from activated queue
-        activatedSTEs.pop_back();
-
-        s->enableChildSTEs(&enabledSTEs);
+        ctx.activatedSTEs.pop_back();
+
+        // enable children that were not already enabled
+        for(uint32_t k = s.succ_begin; k < s.succ_end; k++) {
+            uint32_t child = successors[k];
+            if(!ctx.steEnabled[child]) {
+                ctx.steEnabled[child] = 1;
+                ctx.enabledSTEs.push_back(child);
+
+                // the STE record is read when the next symbol is matched
+                if(F & SIM_PREFETCH)
+                    __builtin_prefetch(&compiled->getSTE(child));
+            }
+        }
 
-        if(specialElements.size() > 0)
-            s->enableChildSpecialElements(&enabledSpecialElements);
+        if((F & SIM_SPECELS) && (s.flags & CSTE_GATE_CHILDREN)) {
+            const GateNetwork *gates = compiled->getGateNetwork();
+            raiseGateInputs(ctx, gates->getSTETargetsBegin(index), gates->getSTETargetsEnd(index));
+        }
 
-        // suggest that the STE deactivate
-        // if we don't, add to the queue
-        if(!s->deactivate()) {
-            // don't mark for removal from activated map
-            latchedSTEs.push_back(s);
+        if((F & SIM_SPECELS) && (s.flags & CSTE_SPECEL_CHILDREN)) {
+            const GateNetwork *gates = compiled->getGateNetwork();
+            raiseSpecialElementPorts(ctx, gates->getSTEPortTargetsBegin(index), gates->getSTEPortTargetsEnd(index));
         }
-        
     }
-    
-    // refil activated elements
-    while(!latchedSTEs.empty()) {
-        activatedSTEs.push_back(latchedSTEs.back());
-        latchedSTEs.pop_back();
+}
+
+/**
+ * Enables the STE children of a special element given its compiled index.
+ */
+void Automata::enableSpecialElementChildSTEs(SimulationContext &ctx, uint32_t specel_index) {
+
+    const uint32_t *end = compiled->getSpecialElementSuccessorsEnd(specel_index);
+    for(const uint32_t *child = compiled->getSpecialElementSuccessorsBegin(specel_index); child != end; child++) {
+        if(!ctx.steEnabled[*child]) {
+            ctx.steEnabled[*child] = 1;
+            ctx.enabledSTEs.push_back(*child);
+        }
     }
 }
 
 /**
- * BFS that only considers special Elements once per post STE cycle
- *  Special Element compute order starts with those that only have STE parents
- *  and then progresses, adding new elements when all parent special elements
- *  have been considered.
+ * Raises the given gate inputs of the GateNetwork for this cycle. Updates the "some input high" and "all inputs high" words of each gate.
  */
-void Automata::specialElementSimulation2() {
+inline void Automata::raiseGateInputs(SimulationContext &ctx, const uint32_t *begin, const uint32_t *end) {
 
-    // Calculate all specels in order
-    for(Element *spel : orderedSpecialElements){
-        
-        // calculate
-        bool result = static_cast<SpecialElement*>(spel)->calculate();
+    const GateNetwork *gates = compiled->getGateNetwork();
 
-        // DO WE ACTIVATE?
-        if(result){
+    for(const uint32_t *input = begin; input != end; input++) {
 
-            // activate
-            if(!spel->isActivated()){
-                spel->activate();
-            }
-            
-            // report?
-            if(report && spel->isReporting()) {
-                reportVector.push_back(make_pair(cycle, spel->getId()));
-            }
-        }
+        // each input is raised at most once per cycle
+        if(ctx.gateInputHigh[*input])
+            continue;
 
-        // disable
-        spel->disable();
-        
-        // for all children
-        // enable them if we activated
-        if(result){
-            spel->enableChildSTEs(&enabledSTEs);
-            spel->enableChildSpecialElements(&enabledSpecialElements);
+        ctx.gateInputHigh[*input] = 1;
+        ctx.raisedGateInputs.push_back(*input);
+
+        uint32_t gate = gates->getInputGate(*input);
+        uint64_t bit = 1ULL << (gate & 63);
+
+        if(ctx.gateHighCount[gate]++ == 0) {
+            ctx.raisedGates.push_back(gate);
+            ctx.gateAny[gate >> 6] |= bit;
         }
+
+        if(ctx.gateHighCount[gate] >= gates->getNumGateInputs(gate))
+            ctx.gateAll[gate >> 6] |= bit;
     }
 }
 
 /**
- * Simulates SpecialElements. SpecialElements are unbuffered and behave as traditional electrical circuit elements. Therefore, all special elements need to continuously calculate based on their inputs until a steady state is reached. SpecialElement simulation is extremely slow compared to STE-only simulation.
+ * Raises the given ports of special elements that are not gates for this cycle.
  */
-void Automata::specialElementSimulation() {
+inline void Automata::raiseSpecialElementPorts(SimulationContext &ctx, const uint32_t *begin, const uint32_t *end) {
+
+    for(const uint32_t *target = begin; target != end; target++) {
+        SpecialElementState &state = ctx.specelStates[GateNetwork::getPortTargetSpecialElement(*target)];
+        state.enabled = true;
+        state.port_high[GateNetwork::getPortTargetPort(*target)]++;
+    }
+}
 
-    // circuit simulation happens between automata processing
-    // all circuit elements (specels) are considered
-    // elements are considered from root nodes (specels that are children of STEs)
-    // computation proceeds until all elements enable STEs and have no more circuit children
+/**
+ * Propagates the output of a special element that calculated true this cycle: records the activation and enables its gate and other special element children. Its report and STE children are handled by specialElementSimulation2() once all levels were calculated.
+ */
+inline void Automata::fireSpecialElement(SimulationContext &ctx, uint32_t specel_index) {
 
-    map<uint32_t, bool> calculated;
-    map<uint32_t, bool> queued;
+    const GateNetwork *gates = compiled->getGateNetwork();
 
-    queue<SpecialElement *> work_q;
-    
-    // initialize tracking structures
-    for( auto e : elements) {
-        
-        // initialize claculated map
-        calculated[e.second->getIntId()] = false;
+    // activate
+    ctx.specelStates[specel_index].activated = true;
+    ctx.firedSpecialElements.push_back(specel_index);
 
-        // initialize queued map
-        queued[e.second->getIntId()] = false;
-    }
+    // for all special element children
+    raiseGateInputs(ctx, gates->getSpecialElementTargetsBegin(specel_index), gates->getSpecialElementTargetsEnd(specel_index));
+    raiseSpecialElementPorts(ctx, gates->getSpecialElementPortTargetsBegin(specel_index), gates->getSpecialElementPortTargetsEnd(specel_index));
+}
 
-    // fill work_q with specel children of STEs
-    for(auto e : elements) {
-        if(!e.second->isSpecialElement()){
+/**
+ * Levelized special element simulation. Levels of the GateNetwork are considered in order, so every special element is calculated once per post STE cycle, after all of its special element parents. Within a level, the gates are calculated 64 at a time from their input words, and only gates that calculated true are visited; counters and other special elements are then calculated one at a time. Special elements that fired report and enable their STE children in compiled order, so reports and enables come out in the same order as with one special element calculated at a time.
+ */
+void Automata::specialElementSimulation2(SimulationContext &ctx) {
 
-            for( auto sp : e.second->getOutputSpecelPointers() ) {
+    const GateNetwork *gates = compiled->getGateNetwork();
 
-                SpecialElement *specel = static_cast<SpecialElement*>(sp.first);
-                if(!queued[specel->getIntId()]){
-                    work_q.push(specel);
-                    queued[specel->getIntId()] = true;
-                }
-            }
-            
-            // indicate that this parent has already calculated
-            calculated[e.second->getIntId()] = true;
-        }
-    } 
+    // activations only hold for one cycle
+    for(uint32_t specel_index : ctx.firedSpecialElements) {
+        ctx.specelStates[specel_index].activated = false;
+    }
+    ctx.firedSpecialElements.clear();
 
-    // while workq is not empty
-    while(!work_q.empty()){
+    for(uint32_t level = 0; level < gates->getNumLevels(); level++) {
 
-        // get front
-        SpecialElement * spel = work_q.front();
-        work_q.pop();
+        // gates of this level
+        for(uint32_t w = gates->getLevelWordsBegin(level); w < gates->getLevelWordsEnd(level); w++) {
 
-        // if all parents have already calculated
-        bool ready = true;
-        for(auto in : spel->getInputs()){
+            uint64_t result = gates->evaluate(w, ctx.gateAny[w], ctx.gateAll[w]);
 
-            if(!calculated[getElement(in.first)->getIntId()]){
-                ready = false;
-                break;
+            // fire every gate that calculated true
+            while(result) {
+                uint32_t gate = (w << 6) + __builtin_ctzll(result);
+                result &= result - 1;
+
+                fireSpecialElement(ctx, gates->getSpecialElementIndex(gate));
             }
         }
 
-        // execute if all our inputs are ready
-        if(ready){
-            
-            // calculate
-            calculated[spel->getIntId()] = true;
-            bool emitOutput = spel->calculate();
+        // other special elements of this level
+        const uint32_t *end = gates->getLevelOthersEnd(level);
+        for(const uint32_t *index = gates->getLevelOthersBegin(level); index != end; index++) {
 
-            // if we calculated true
-            if(emitOutput) {
+            SpecialElementState &state = ctx.specelStates[*index];
 
-                // activate
-                if(!spel->isActivated()){
-                    spel->activate();
-                }
-                
-                // report?
-                if(report && spel->isReporting()) {
-                    reportVector.push_back(make_pair(cycle, spel->getId()));
-                }
-                
-            }
-            
-            // disable
-            spel->disable();
+            // calculate
+            bool result = compiled->getSpecialElement(*index)->calculate(state);
 
-            // for all children
-            // enable them if we activated
-            if(emitOutput){
-                spel->enableChildSTEs(&enabledSTEs);
-                spel->enableChildSpecialElements(&enabledSpecialElements);
-            }
+            // disable
+            state.port_high[PORT_NONE] = 0;
+            state.port_high[PORT_CNT] = 0;
+            state.port_high[PORT_RST] = 0;
+            state.enabled = false;
+
+            // enable children if we activated
+            if(result)
+                fireSpecialElement(ctx, *index);
+        }
+    }
 
-            //// if child is specel
-            for(auto e : spel->getOutputSpecelPointers()){
-            
-                ////// push to queue to consider 
-                SpecialElement *spel_child = static_cast<SpecialElement*>(e.first);
-                if(!queued[spel_child->getIntId()]){
-                    work_q.push(spel_child);
-                    queued[spel_child->getIntId()] = true;
-                }
+    // report and enable STE children in compiled order
+    sort(ctx.firedSpecialElements.begin(), ctx.firedSpecialElements.end());
+    for(uint32_t specel_index : ctx.firedSpecialElements) {
 
-            }
+        // report?
+        if(report && compiled->getSpecialElement(specel_index)->isReporting()) {
+            ctx.reportSink->report(ctx.cycle, compiled->getSpecialElementId(specel_index));
         }
+
+        enableSpecialElementChildSTEs(ctx, specel_index);
     }
-}
 
+    // gate inputs only hold for one cycle
+    ctx.clearGateInputs();
+}
 
 /**
  * Tick advances the cycle count representing an automata "symbol cycle."
  */
-uint64_t Automata::tick() {
+uint64_t Automata::tick(SimulationContext &ctx) {
+
+    return ctx.cycle++;
+}
+
+/**
+ * Splits a candidate set into buckets of STEs with equal signatures, in order of first appearance, and empties the candidate set. STEs in different buckets can never be merged with each other, so only STEs within a bucket need to be compared. Reporting STEs are never merged and get a bucket of their own.
+ */
+static vector<queue<STE*>> bucketBySignature(queue<STE*> &candidates, uint64_t (STE::*signature)()) {
+
+    vector<queue<STE*>> buckets;
+    unordered_map<uint64_t, uint32_t> index;
 
-    return cycle++;
+    while(!candidates.empty()) {
+        STE *ste = candidates.front();
+        candidates.pop();
+
+        if(ste->isReporting()) {
+            buckets.push_back(queue<STE*>());
+            buckets.back().push(ste);
+            continue;
+        }
+
+        uint64_t key = (ste->*signature)();
+        auto it = index.find(key);
+        if(it == index.end()) {
+            index[key] = buckets.size();
+            buckets.push_back(queue<STE*>());
+            buckets.back().push(ste);
+        }else{
+            buckets[it->second].push(ste);
+        }
+    }
+
+    return buckets;
 }
 
 /**
@@ -2652,47 +3464,51 @@ uint32_t Automata::mergeCommonPrefixes() {
         // grab candidate set
         queue<STE*> *candidates = workq.front();
         queue<STE*> candidates_tmp;
-        
-        // try to merge all candidates
-        while(!candidates->empty()) {
 
-            STE * first = candidates->front();
-            candidates->pop();
-            
-            while(!candidates->empty()) {
-                STE * second = candidates->front();
-                candidates->pop();
-                
-                //if the two STEs have identical prefixes, merge
-                if(first->leftCompare(second)) {
-                    merged++;
-                    leftMergeSTEs(first, second);
-                    //else push back onto workq
-                } else {
-                    candidates_tmp.push(second);
-                }	 
-            }
+        // only STEs with equal signatures can have identical prefixes
+        for(queue<STE*> &bucket : bucketBySignature(*candidates, &STE::leftSignature)) {
 
-            // Add all children of first to new candidate set
-            queue<STE*> *next_candidate_set = new queue<STE*>;
-            for(auto c : first->getOutputSTEPointers()) {
-                STE * child = static_cast<STE*>(c.first);
-                if(!child->isMarked()){
-                    child->mark();
-                    next_candidate_set->push(child);
+            // try to merge all candidates
+            while(!bucket.empty()) {
+
+                STE * first = bucket.front();
+                bucket.pop();
+
+                while(!bucket.empty()) {
+                    STE * second = bucket.front();
+                    bucket.pop();
+
+                    //if the two STEs have identical prefixes, merge
+                    if(first->leftCompare(second)) {
+                        merged++;
+                        leftMergeSTEs(first, second);
+                        //else push back onto workq
+                    } else {
+                        candidates_tmp.push(second);
+                    }
                 }
-            }
 
-            // consider candidate set at the back of the queue
-            if(next_candidate_set->size() > 0)
-                workq.push(next_candidate_set);
-            else
-                delete next_candidate_set;
-            
-            // try another candidate in this candidate set
-            while(!candidates_tmp.empty()){
-                candidates->push(candidates_tmp.front());
-                candidates_tmp.pop();
+                // Add all children of first to new candidate set
+                queue<STE*> *next_candidate_set = new queue<STE*>;
+                for(auto c : first->getOutputSTEPointers()) {
+                    STE * child = static_cast<STE*>(c.first);
+                    if(!child->isMarked()){
+                        child->mark();
+                        next_candidate_set->push(child);
+                    }
+                }
+
+                // consider candidate set at the back of the queue
+                if(next_candidate_set->size() > 0)
+                    workq.push(next_candidate_set);
+                else
+                    delete next_candidate_set;
+
+                // try another candidate in this bucket
+                while(!candidates_tmp.empty()){
+                    bucket.push(candidates_tmp.front());
+                    candidates_tmp.pop();
+                }
             }
         }
 
@@ -2812,49 +3628,53 @@ uint32_t Automata::mergeCommonSuffixes() {
         queue<STE*> *candidates = workq.front();
         queue<STE*> candidates_tmp;
         
-        // try to merge all candidates
-        while(!candidates->empty()) {
-
-            STE * first = candidates->front();
-            candidates->pop();
-            
-            while(!candidates->empty()) {
-                STE * second = candidates->front();
-                candidates->pop();
-                
-                //if the two STEs have identical prefixes, merge
-                if(first->rightCompare(second)) {
-                    merged++;
-                    rightMergeSTEs(first, second);
-                    //else push back onto workq
-                } else {
-                    candidates_tmp.push(second);
-                }	 
-            }
+        // only STEs with equal signatures can have identical suffixes
+        for(queue<STE*> &bucket : bucketBySignature(*candidates, &STE::rightSignature)) {
+
+            // try to merge all candidates
+            while(!bucket.empty()) {
+
+                STE * first = bucket.front();
+                bucket.pop();
+
+                while(!bucket.empty()) {
+                    STE * second = bucket.front();
+                    bucket.pop();
+
+                    //if the two STEs have identical suffixes, merge
+                    if(first->rightCompare(second)) {
+                        merged++;
+                        rightMergeSTEs(first, second);
+                        //else push back onto workq
+                    } else {
+                        candidates_tmp.push(second);
+                    }
+                }
 
-            // Add all children of first to new candidate set
-            queue<STE*> *next_candidate_set = new queue<STE*>;
-            for(auto c : first->getInputs()) {
-                Element *el = getElement(c.first);
-                if(!el->isSpecialElement()) {
-                    STE * child = static_cast<STE*>(el);
-                    if(!child->isMarked()){
-                        child->mark();
-                        next_candidate_set->push(child);
+                // Add all parents of first to new candidate set
+                queue<STE*> *next_candidate_set = new queue<STE*>;
+                for(auto c : first->getInputs()) {
+                    Element *el = getElement(c.first);
+                    if(!el->isSpecialElement()) {
+                        STE * child = static_cast<STE*>(el);
+                        if(!child->isMarked()){
+                            child->mark();
+                            next_candidate_set->push(child);
+                        }
                     }
                 }
-            }
 
-            // consider candidate set at the back of the queue
-            if(next_candidate_set->size() > 0)
-                workq.push(next_candidate_set);
-            else
-                delete next_candidate_set;
-            
-            // try another candidate in this candidate set
-            while(!candidates_tmp.empty()){
-                candidates->push(candidates_tmp.front());
-                candidates_tmp.pop();
+                // consider candidate set at the back of the queue
+                if(next_candidate_set->size() > 0)
+                    workq.push(next_candidate_set);
+                else
+                    delete next_candidate_set;
+
+                // try another candidate in this bucket
+                while(!candidates_tmp.empty()){
+                    bucket.push(candidates_tmp.front());
+                    candidates_tmp.pop();
+                }
             }
         }
 
@@ -2952,30 +3772,24 @@ uint32_t Automata::mergeCommonSuffixes(queue<STE *> &workq) {
 
 /**
  * If two STEs share the same parents and the same children, they can be combined into
- *   one STE with the union of their character sets.
+ *   one STE with the union of their character sets. Candidates are bucketed by a
+ *   signature of their start type, parents and children, so only STEs that are likely
+ *   identical are compared.
  */
 uint32_t Automata::mergeCommonPaths() {
 
     uint32_t merged = 0;
-    
-    //
-    unmarkAllElements();
 
     //
     queue<STE*> to_remove;
-    
-    // for each element
+
+    // every non-reporting STE with STE children is a candidate
+    queue<STE*> candidates;
     for(auto e : elements) {
-        
+
         //
         Element *el = e.second;
 
-        // skip if we've been removed
-        if(el->isMarked())
-            continue;
-
-        el->mark();
-        
         // skip special elements
         if(el->isSpecialElement())
             continue;
@@ -2983,46 +3797,50 @@ uint32_t Automata::mergeCommonPaths() {
         // skip reporting elements
         if(el->isReporting())
             continue;
-        
-        // find candidates to compare
-        // all children's parents
-        for(string c : el->getOutputs()){
 
-            Element *child = getElement(c);
-            if(child->isSpecialElement())
-                continue;
+        if(el->getOutputSTEPointers().empty())
+            continue;
 
-            
-            for(auto p : child->getInputs()){
-                Element * childs_parent = getElement(p.first);
+        candidates.push(static_cast<STE*>(el));
+    }
 
-                if(childs_parent->isSpecialElement())
-                    continue;
+    queue<STE*> candidates_tmp;
+    for(queue<STE*> &bucket : bucketBySignature(candidates, &STE::pathSignature)) {
+
+        while(!bucket.empty()) {
+
+            STE *ste1 = bucket.front();
+            bucket.pop();
+
+            while(!bucket.empty()) {
+                STE *ste2 = bucket.front();
+                bucket.pop();
 
-                // skip if we've already considered this one
-                if(childs_parent->isMarked())
-                    continue;
-                
                 // if the two elements share identical parents and children lists
-                if(el->identicalInputs(childs_parent) &&
-                   el->identicalOutputs(childs_parent)) {
+                if(ste1->getStart() == ste2->getStart() &&
+                   ste1->identicalInputs(ste2) &&
+                   ste1->identicalOutputs(ste2)) {
 
-                    STE *ste1 = static_cast<STE*>(el);
-                    STE *ste2 = static_cast<STE*>(childs_parent);
-                    
-                    // add charset of childs_parent to el
+                    // add charset of ste2 to ste1
                     for(uint32_t symbol = 0; symbol < 256; symbol++) {
                         if(ste2->match(symbol))
                             ste1->addSymbolToSymbolSet(symbol);
                     }
 
                     // delete ste2
-                    ste2->mark();
                     to_remove.push(ste2);
 
                     merged++;
+                } else {
+                    candidates_tmp.push(ste2);
                 }
             }
+
+            // try another candidate in this bucket
+            while(!candidates_tmp.empty()){
+                bucket.push(candidates_tmp.front());
+                candidates_tmp.pop();
+            }
         }
     }
 
@@ -3195,14 +4013,17 @@ void Automata::printGraphStats() {
  */
 void Automata::rightMergeSTEs(STE *ste1, STE *ste2){
 
+    // copy; removing edges modifies ste2's inputs
+    map<string, bool> inputs = ste2->getInputs();
+
     // add all inputs to ste1
-    for(auto input : ste2->getInputs()){
+    for(auto input : inputs){
         STE *in_ste = static_cast<STE*>(getElement(input.first));
         addEdge(in_ste, ste1);
     }
 
     // 
-    for(auto input : ste2->getInputs()){
+    for(auto input : inputs){
         STE *in_ste = static_cast<STE*>(getElement(input.first));
         removeEdge(in_ste, ste2);
     }
@@ -3499,18 +4320,19 @@ void Automata::enforceFanOut(uint32_t fanout_max){
 /**
  * Dumps active states on parameter designated cycle to file stes_<cycle>.state
  */
-void Automata::dumpSTEState(string filename) {
+void Automata::dumpSTEState(SimulationContext &ctx, string filename) {
 
     string s = "";
 
-    queue<STE*> temp;
+    queue<uint32_t> temp;
 
     // print activated STEs
-    while(!activatedSTEs.empty()){
+    while(!ctx.activatedSTEs.empty()){
 
-        STE * ste = activatedSTEs.back();
-        temp.push(ste);
-        activatedSTEs.pop_back();
+        uint32_t index = ctx.activatedSTEs.back();
+        STE * ste = compiled->getSTEElement(index);
+        temp.push(index);
+        ctx.activatedSTEs.pop_back();
         // print ID
         s += ste->getId();
         s += "\n";
@@ -3518,7 +4340,7 @@ void Automata::dumpSTEState(string filename) {
 
     // restore activated STEs
     while(!temp.empty()){
-        activatedSTEs.push_back(temp.front());
+        ctx.activatedSTEs.push_back(temp.front());
         temp.pop();
     }
 
@@ -3526,34 +4348,31 @@ void Automata::dumpSTEState(string filename) {
 }
 
 /**
- * Dumps active special elements on parameter designated cycle to file stes_<cycle>.state
+ * Dumps active special elements of the given context on parameter designated cycle to file stes_<cycle>.state
  *  *always* dumps counters and prints the current counter value and target.
  */
-void Automata::dumpSpecelState(string filename) {
+void Automata::dumpSpecelState(SimulationContext &ctx, string filename) {
 
     string s = "";
 
     // print activated Specials
-    for(auto e : elements){
+    for(uint32_t index = 0; index < compiled->getNumSpecialElements(); index++){
 
-        if(e.second->isSpecialElement()){
-            SpecialElement * specel = static_cast<SpecialElement*>(e.second);
-           
-            // if counter, print ID and target
-            if(dynamic_cast<Counter*>(specel)){
+        SpecialElement * specel = compiled->getSpecialElement(index);
+        const SpecialElementState &state = ctx.specelStates[index];
+
+        // if counter, print ID and target
+        if(dynamic_cast<Counter*>(specel)){
+            s += specel->getId();
+            Counter *c = static_cast<Counter*>(specel);
+            s += " " + to_string(state.value) + " " + to_string(c->getTarget());
+            s += "\n";
+        }else{
+            // if its just a specel, only print its ID if it activated
+            if(state.activated){
                 s += specel->getId();
-                Counter *c = static_cast<Counter*>(specel);
-                s += " " + to_string(c->getValue()) + " " + to_string(c->getTarget());
                 s += "\n";
-            }else{
-                // if its just a specel, only print its ID if it activated
-                if(specel->isActivated()){
-                     s += specel->getId();
-                     s += "\n";
-                }
             }
-
-
         }
     }
 
@@ -3565,6 +4384,8 @@ void Automata::dumpSpecelState(string filename) {
  */
 void Automata::removeEdge(Element* from, Element *to) {
 
+    invalidateCompiledAutomata();
+
     from->removeOutput(to->getId());
     from->removeOutputPointer(make_pair(to, to->getId()));
     to->removeInput(from->getId());
@@ -3575,6 +4396,8 @@ void Automata::removeEdge(Element* from, Element *to) {
  */
 void Automata::removeEdge(string from_str, string to_str) {
 
+    invalidateCompiledAutomata();
+
     Element *from = getElement(from_str);
     Element *to = getElement(to_str);
 
@@ -3601,6 +4424,8 @@ void Automata::removeEdge(string from_str, string to_str) {
  */
 void Automata::addEdge(Element* from, Element *to){
 
+    invalidateCompiledAutomata();
+
     from->addOutput(to->getId());
 
     // output pointers are paired with the output port
@@ -3614,6 +4439,8 @@ void Automata::addEdge(Element* from, Element *to){
  */
 void Automata::addEdge(string from_str, string to_str) {
 
+    invalidateCompiledAutomata();
+
     Element *from = getElement(from_str);
     Element *to = getElement(to_str);
 
@@ -3647,14 +4474,16 @@ void Automata::updateElementId(Element *el, string newId) {
     vector<string> parents;
 
     // remove old outputs
-    for(string output : el->getOutputs()) {
+    vector<string> outputs = el->getOutputs();
+    for(string output : outputs) {
         removeEdge(el->getId(), output);
         // save child
         children.push_back(output);
     }
 
     // remove old inputs
-    for(pair<string,bool> input : el->getInputs()){
+    map<string, bool> inputs = el->getInputs();
+    for(pair<string,bool> input : inputs){
         removeEdge(input.first, el->getId());
         // save parent
         parents.push_back(input.first);
@@ -3746,6 +4575,8 @@ void Automata::validateReportElement(Element* el){
  */
 void Automata::validateElement(Element* el) {
 
+    invalidateCompiledAutomata();
+
     elements[el->getId()] = el;
     
     // make sure we're in the start array if we're a start and vice versa
@@ -3764,7 +4595,9 @@ void Automata::validateElement(Element* el) {
  */
 Element *Automata::getElement(std::string elementId) {
 
-    Element *el = elements[Element::stripPort(elementId)];
+    // find() so that lookups of missing ids don't insert NULL entries
+    auto it = elements.find(Element::stripPort(elementId));
+    Element *el = (it == elements.end()) ? NULL : it->second;
 
     if(el == NULL){
         setErrorCode(E_ELEMENT_NOT_FOUND);
@@ -3802,135 +4635,141 @@ void Automata::unmarkAllElements() {
 }
 
 /**
- * Removes elements that are unreachable or cannot result in a match.
+ * Removes elements that are unreachable or cannot result in a match. Elements that can reach a report are found with one reverse breadth first search from all reporting elements; of those, the ones reachable from a start state or from a special element that activates without an enabled input are found with one forward search. The inputs of kept special elements are kept as well, because removing them would change when AND gates and inverters fire. Both run over the integer adjacency of an ElementGraph, so the whole pass is linear in the size of the automata. Returns the number of removed elements.
  */
-void Automata::eliminateDeadStates() {
-
-    // if we can't reach a report state, we should be eliminated
-    // for each state, check if we can reach a report state
-    queue<Element *> toRemove;
-    for(auto e : elements){
+uint32_t Automata::eliminateDeadStates() {
 
-        // unmark all elements
-        unmarkAllElements();
-        
-        Element *el = e.second;
+    ElementGraph graph(elements);
+    uint32_t n = graph.size();
 
-        // Can we reach a report state from el?
-        bool report_unreachable = true;
-        
-        // are we a report state?
-        if(el->isReporting()) {
-            el->mark();
-            report_unreachable = false;
+    // live elements can reach a report state: search backwards from all of them
+    vector<uint8_t> live(n, 0);
+    vector<uint32_t> workq;
+    for(Element *el : getReports()){
+        uint32_t report = graph.getId(el);
+        if(!live[report]){
+            live[report] = 1;
+            workq.push_back(report);
         }
-        
-        queue<Element *> workq;
-        // push outputs to workq
-        for(string out : el->getOutputs()){
-            Element *output = getElement(out);
-            if(output->isReporting()) {
-                report_unreachable = false;
-            }
+    }
 
-            // push to queue
-            if(!output->isMarked()) {
-                output->mark();
-                workq.push(output);
-            }
-        }
+    for(size_t head = 0; head < workq.size(); head++){
 
-        // BFS and attempt to find a report state
-        while(!workq.empty() && report_unreachable){
+        uint32_t parent = workq[head];
 
-            Element *child = workq.front();
-            workq.pop();
-            
-            for(string out : child->getOutputs()){
-                Element *output = getElement(out);
-                if(output->isReporting()) {
-                    report_unreachable = false;
-                }
-                
-                // push to queue
-                if(!output->isMarked()) {
-                    output->mark();
-                    workq.push(output);
-                }
+        for(const GraphEdge *e = graph.predBegin(parent); e != graph.predEnd(parent); e++){
+            if(!live[e->node]) {
+                live[e->node] = 1;
+                workq.push_back(e->node);
             }
         }
+    }
 
-        //
-        if(report_unreachable){
-            toRemove.push(el);
+    // we also need to find elements that are unreachable from start states
+    //   even if they can lead to reports
+    // BFS all reachable live states from the live start states
+    vector<uint8_t> reachable(n, 0);
+    workq.clear();
+    for(STE *el : getStarts()){
+        uint32_t start = graph.getId(el);
+        if(live[start] && !reachable[start]){
+            reachable[start] = 1;
+            workq.push_back(start);
         }
     }
 
-    // Remove all dead states from the automata
-    while(!toRemove.empty()){
-        Element *el = toRemove.front();
-        toRemove.pop();
-        removeElement(el);
+    // inverters and NOR gates activate without an enabled input, even if
+    //   all of their inputs are unreachable
+    for(auto e : specialElements){
+        uint32_t specel = graph.getId(e.second);
+        if(live[specel] && !reachable[specel] && e.second->canActivateNoEnable()){
+            reachable[specel] = 1;
+            workq.push_back(specel);
+        }
     }
 
+    for(size_t head = 0; head < workq.size(); head++){
 
-    // we also need to find elements that are unreachable from start states
-    //   even if they can lead to reports
-
-    // unmark all elements
-    unmarkAllElements();
-
-    // BFS all reachable states from the start states
-    for(STE *el : getStarts()){
+        uint32_t child = workq[head];
 
-        el->mark();
-        
-        queue<Element *> workq;
-        
-        // push outputs to workq
-        for(string out : el->getOutputs()){
-            Element *output = getElement(out);
-
-            // push to queue
-            if(!output->isMarked()) {
-                output->mark();
-                workq.push(output);
+        for(const GraphEdge *e = graph.succBegin(child); e != graph.succEnd(child); e++){
+            if(live[e->node] && !reachable[e->node]) {
+                reachable[e->node] = 1;
+                workq.push_back(e->node);
             }
         }
+    }
 
-        // BFS and attempt to find a report state
-        while(!workq.empty()){
+    // AND gates and inverters compare their high inputs with all of their
+    //   inputs, so kept special elements keep inputs that never activate
+    uint32_t kept = workq.size();
+    for(auto e : specialElements){
+        uint32_t specel = graph.getId(e.second);
+        if(!reachable[specel])
+            continue;
 
-            Element *child = workq.front();
-            workq.pop();
-            
-            for(string out : child->getOutputs()){
-                Element *output = getElement(out);
-                
-                // push to queue
-                if(!output->isMarked()) {
-                    output->mark();
-                    workq.push(output);
-                }
+        for(const GraphEdge *p = graph.predBegin(specel); p != graph.predEnd(specel); p++){
+            if(!reachable[p->node]) {
+                reachable[p->node] = 1;
+                kept++;
             }
         }
-
     }
 
-    // Remove all dead states from the automata
-    for(auto e : elements){
-        // if an element wasn't marked, delete it
-        if(!e.second->isMarked()){
-            toRemove.push(e.second);
+    if(kept == n)
+        return 0;
+
+    invalidateCompiledAutomata();
+
+    // Remove all dead and unreachable states from the automata. Edges among
+    // removed elements go with them, so only edges to kept elements are cut
+    uint32_t removed = 0;
+    for(uint32_t i = 0; i < n; i++){
+        if(reachable[i])
+            continue;
+
+        Element *el = graph.getElement(i);
+
+        // copy; removing edges modifies el's edge lists
+        vector<string> outputs = el->getOutputs();
+        map<string, bool> inputs = el->getInputs();
+
+        for(string output : outputs){
+            if(reachable[graph.getId(getElement(output))])
+                removeEdge(el->getId(), output);
+        }
+
+        for(pair<string, bool> in : inputs){
+            if(reachable[graph.getId(getElement(in.first))])
+                removeEdge(in.first, el->getId());
         }
     }
-    
-    // remove all unmarked elements
-    while(!toRemove.empty()){
-        Element *el = toRemove.front();
-        toRemove.pop();
-        removeElement(el);
+
+    for(uint32_t i = 0; i < n; i++){
+        if(reachable[i])
+            continue;
+
+        Element *el = graph.getElement(i);
+        if(el->isSpecialElement())
+            specialElements.erase(el->getId());
+        elements.erase(el->getId());
+        removed++;
     }
+
+    // filter the report and start lists once instead of per removed element
+    reports.erase(remove_if(reports.begin(), reports.end(), [&](Element *el) {
+                return !reachable[graph.getId(el)];
+            }), reports.end());
+
+    starts.erase(remove_if(starts.begin(), starts.end(), [&](STE *ste) {
+                return !reachable[graph.getId(ste)];
+            }), starts.end());
+
+    activateNoInputSpecialElements.erase(remove_if(activateNoInputSpecialElements.begin(), activateNoInputSpecialElements.end(), [&](SpecialElement *specel) {
+                return !reachable[graph.getId(specel)];
+            }), activateNoInputSpecialElements.end());
+
+    return removed;
 }
 
 /**
@@ -3946,7 +4785,8 @@ void Automata::removeRedundantEdges() {
         if(ste->getStringStart().compare("all-input") == 0){
 
             // remove all incoming edges
-            for(auto in : ste->getInputs()){
+            map<string, bool> inputs = ste->getInputs();
+            for(auto in : inputs){
                 removeEdge(getElement(in.first), ste);
             }
         }
@@ -3978,6 +4818,17 @@ void Automata::optimize(bool remove_ors,
     }
 
 
+    // DEAD STATE ELIMINATION
+    if(!quiet)
+        cout << " * Eliminating dead states..." << endl;
+
+    chrono::high_resolution_clock::time_point start_time = chrono::high_resolution_clock::now();
+    uint32_t dead = eliminateDeadStates();
+    double duration = chrono::duration<double, std::milli>(chrono::high_resolution_clock::now() - start_time).count();
+
+    if(!quiet)
+        cout << "     removed " << dead << " elements in " << duration << " ms..." << endl;
+
     // NFA REDUCTION ALGORITHMS
     uint32_t automata_size_total = 0;
     while(automata_size_total != elements.size()) {
@@ -4373,9 +5224,10 @@ void Automata::removeCounters(){
             // connect all inputs to outputs
             // yes, this includes both CNT and RST ports
             // unclear what the implications are for your design
+            vector<string> outputs = c->getOutputs();
             for(auto i : c->getInputs()){
                 Element *in = getElement(i.first);
-                for(string o : c->getOutputs()){
+                for(string o : outputs){
                     Element *out = getElement(o);
                     addEdge(in, out);
                     
@@ -0,0 +1,255 @@
+/**
+ * @file
+ */
+#include "binaryAutomataParser.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+BinaryAutomataParser::BinaryAutomataParser(string filename) : filename(filename) {
+
+}
+
+/**
+ * Returns true if count records of record_size bytes starting at offset lie inside size bytes. Never overflows, whatever the values read from the file.
+ */
+static inline bool validSection(uint64_t offset, uint64_t count, uint64_t record_size, uint64_t size) {
+
+    return offset <= size && count <= (size - offset) / record_size;
+}
+
+/**
+ * Returns true if str lies inside a string pool of pool_size bytes.
+ */
+static inline bool validString(const BinaryString &str, uint64_t pool_size) {
+
+    return validSection(str.offset, str.length, 1, pool_size);
+}
+
+/**
+ * Returns the string str from the string pool.
+ */
+static inline string poolString(const char *pool, const BinaryString &str) {
+
+    return string(pool + str.offset, str.length);
+}
+
+/**
+ * Memory maps the binary automata file and builds all elements from it.
+ */
+vasim_err_t BinaryAutomataParser::parse(unordered_map<string, Element*> &elements,
+                                        vector<STE*> &starts,
+                                        vector<Element*> &reports,
+                                        unordered_map<string, SpecialElement*> &specialElements,
+                                        string * id,
+                                        vector<SpecialElement*> &activateNoInputSpecialElements)
+{
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        cout << "Could not load binary automata file: " << filename << endl;
+        return E_FILE_OPEN;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(BinaryAutomataHeader)) {
+        close(fd);
+        cout << "Could not load binary automata file: " << filename << endl;
+        return E_MALFORMED_AUTOMATA;
+    }
+
+    void *image = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(image == MAP_FAILED) {
+        cout << "Could not load binary automata file: " << filename << endl;
+        return E_FILE_OPEN;
+    }
+
+    madvise(image, st.st_size, MADV_SEQUENTIAL);
+
+    vasim_err_t result = parseImage((const uint8_t *)image, st.st_size,
+                                    elements, starts, reports, specialElements,
+                                    id, activateNoInputSpecialElements);
+
+    munmap(image, st.st_size);
+
+    if(result != E_SUCCESS)
+        cout << "Malformed binary automata file: " << filename << endl;
+
+    return result;
+}
+
+/**
+ * Validates the file image and creates one Element per record. Edges are wired directly by index, filling in outputs, output pointers and inputs exactly as finalizeAutomata() would. The graph is built on its own and only added to the given containers once the whole image was read, so a malformed image leaves them untouched.
+ */
+vasim_err_t BinaryAutomataParser::parseImage(const uint8_t *image, uint64_t size,
+                                             unordered_map<string, Element*> &elements,
+                                             vector<STE*> &starts,
+                                             vector<Element*> &reports,
+                                             unordered_map<string, SpecialElement*> &specialElements,
+                                             string * id,
+                                             vector<SpecialElement*> &activateNoInputSpecialElements)
+{
+
+    const BinaryAutomataHeader *header = (const BinaryAutomataHeader *)image;
+
+    // identify file
+    if(memcmp(header->magic, BINARY_AUTOMATA_MAGIC, sizeof(header->magic)) != 0 ||
+       header->version != BINARY_AUTOMATA_VERSION ||
+       header->byte_order != BINARY_AUTOMATA_BYTE_ORDER ||
+       header->file_size != size) {
+        return E_MALFORMED_AUTOMATA;
+    }
+
+    // sections must lie inside the file
+    if(!validSection(header->elements_offset, header->num_elements, sizeof(BinaryElement), size) ||
+       !validSection(header->edges_offset, header->num_edges, sizeof(BinaryEdge), size) ||
+       !validSection(header->strings_offset, header->strings_size, 1, size) ||
+       !validString(header->id, header->strings_size)) {
+        return E_MALFORMED_AUTOMATA;
+    }
+
+    const BinaryElement *records = (const BinaryElement *)(image + header->elements_offset);
+    const BinaryEdge *edges = (const BinaryEdge *)(image + header->edges_offset);
+    const char *pool = (const char *)(image + header->strings_offset);
+
+    // records must reference valid strings and edges
+    for(uint32_t i = 0; i < header->num_elements; i++) {
+        const BinaryElement &r = records[i];
+        if(r.type > COUNTER_T ||
+           r.edges_begin > r.edges_end || r.edges_end > header->num_edges ||
+           !validString(r.id, header->strings_size) ||
+           !validString(r.symbol_set, header->strings_size) ||
+           !validString(r.report_code, header->strings_size)) {
+            return E_MALFORMED_AUTOMATA;
+        }
+    }
+
+    for(uint32_t i = 0; i < header->num_edges; i++) {
+        if(edges[i].to >= header->num_elements ||
+           !validString(edges[i].port, header->strings_size)) {
+            return E_MALFORMED_AUTOMATA;
+        }
+    }
+
+    // create elements
+    vector<Element *> by_index;
+    by_index.reserve(header->num_elements);
+    unordered_map<string, Element*> new_elements;
+    new_elements.reserve(header->num_elements);
+    vector<STE*> new_starts;
+    vector<Element*> new_reports;
+    vector<SpecialElement*> new_specels;
+    vector<SpecialElement*> new_activate_no_input;
+
+    for(uint32_t i = 0; i < header->num_elements; i++) {
+
+        const BinaryElement &r = records[i];
+        string element_id = poolString(pool, r.id);
+        Element *el;
+
+        // ids must be unique; drop everything built so far
+        if(new_elements.find(element_id) != new_elements.end() ||
+           elements.find(element_id) != elements.end()) {
+            for(Element *built : by_index)
+                delete built;
+            return E_MALFORMED_AUTOMATA;
+        }
+
+        if(r.type == STE_T) {
+
+            bitset<256> column;
+            for(uint32_t symbol = 0; symbol < 256; symbol++) {
+                if((r.column[symbol >> 6] >> (symbol & 63)) & 1)
+                    column.set(symbol);
+            }
+
+            string start = "none";
+            if(r.flags & BE_START_OF_DATA)
+                start = "start-of-data";
+            else if(r.flags & BE_ALL_INPUT)
+                start = "all-input";
+
+            STE *s = new STE(element_id, poolString(pool, r.symbol_set), column, start);
+            if(s->isStart())
+                new_starts.push_back(s);
+            el = s;
+
+        } else {
+
+            SpecialElement *specel;
+            switch(r.type) {
+            case AND_T:
+                specel = new AND(element_id);
+                break;
+            case OR_T:
+                specel = new OR(element_id);
+                break;
+            case NOR_T:
+                specel = new NOR(element_id);
+                new_activate_no_input.push_back(specel);
+                break;
+            case INVERTER_T:
+                specel = new Inverter(element_id);
+                new_activate_no_input.push_back(specel);
+                break;
+            default: {
+                string mode = "pulse";
+                if(r.flags & BE_COUNTER_LATCH)
+                    mode = "latch";
+                else if(r.flags & BE_COUNTER_ROLL)
+                    mode = "roll";
+                specel = new Counter(element_id, r.target, mode);
+                break;
+            }
+            }
+
+            new_specels.push_back(specel);
+            el = specel;
+        }
+
+        el->setIntId(i);
+        el->setEod(r.flags & BE_EOD);
+        if(r.flags & BE_REPORTING) {
+            el->setReporting(true);
+            el->setReportCode(poolString(pool, r.report_code));
+            new_reports.push_back(el);
+        }
+
+        new_elements[element_id] = el;
+        by_index.push_back(el);
+    }
+
+    // wire edges
+    for(uint32_t i = 0; i < header->num_elements; i++) {
+
+        Element *parent = by_index[i];
+
+        for(uint32_t e = records[i].edges_begin; e < records[i].edges_end; e++) {
+
+            Element *child = by_index[edges[e].to];
+            string port = poolString(pool, edges[e].port);
+
+            parent->addOutput(child->getId() + port);
+            parent->addOutputPointer(make_pair(child, port));
+            child->addInput(parent->getId() + port);
+        }
+    }
+
+    // the whole image was read
+    *id = poolString(pool, header->id);
+    elements.insert(new_elements.begin(), new_elements.end());
+    starts.insert(starts.end(), new_starts.begin(), new_starts.end());
+    reports.insert(reports.end(), new_reports.begin(), new_reports.end());
+    for(SpecialElement *specel : new_specels)
+        specialElements[specel->getId()] = specel;
+    activateNoInputSpecialElements.insert(activateNoInputSpecialElements.end(),
+                                          new_activate_no_input.begin(), new_activate_no_input.end());
+
+    return E_SUCCESS;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file
+ */
+#include "bitParallelEngine.h"
+
+using namespace std;
+
+/**
+ * Builds the bit vector representation of an STE-only automata. Bit i of every vector corresponds to STE i of the compiled automata, so the compiled STE order determines how compact successor masks are.
+ */
+BitParallelEngine::BitParallelEngine(CompiledAutomata *compiled) : compiled(compiled) {
+
+    num_stes = compiled->getNumSTEs();
+    num_words = (num_stes + 63) / 64;
+
+    match_table.assign(256 * (size_t)num_words, 0);
+    all_input_mask.assign(num_words, 0);
+    start_of_data_mask.assign(num_words, 0);
+    report_mask.assign(num_words, 0);
+    eod_report_mask.assign(num_words, 0);
+    enabled.assign(num_words, 0);
+    activated.assign(num_words, 0);
+
+    const uint32_t *successors = compiled->getSuccessors();
+
+    for(uint32_t i = 0; i < num_stes; i++) {
+
+        const CompiledSTE &s = compiled->getSTE(i);
+        uint32_t word = i / 64;
+        uint64_t bit = 1ULL << (i % 64);
+
+        // fill in the per-symbol match masks from the STE column
+        for(uint32_t symbol = 0; symbol < 256; symbol++) {
+            if(s.match(symbol))
+                match_table[symbol * (size_t)num_words + word] |= bit;
+        }
+
+        if(s.flags & CSTE_ALL_INPUT)
+            all_input_mask[word] |= bit;
+
+        if(s.flags & CSTE_START_OF_DATA)
+            start_of_data_mask[word] |= bit;
+
+        if(s.flags & CSTE_REPORTING) {
+            if(s.flags & CSTE_EOD)
+                eod_report_mask[word] |= bit;
+            else
+                report_mask[word] |= bit;
+        }
+
+        // collapse sorted child indices into word masks
+        vector<uint32_t> children(successors + s.succ_begin, successors + s.succ_end);
+        sort(children.begin(), children.end());
+
+        succ_offsets.push_back(succ_words.size());
+        for(uint32_t child : children) {
+            uint32_t child_word = child / 64;
+            uint64_t child_bit = 1ULL << (child % 64);
+
+            if(succ_words.size() > succ_offsets.back() && succ_words.back() == child_word) {
+                succ_masks.back() |= child_bit;
+            }else{
+                succ_words.push_back(child_word);
+                succ_masks.push_back(child_bit);
+            }
+        }
+    }
+    succ_offsets.push_back(succ_words.size());
+}
+
+/**
+ * Enables all "start-of-data" start states if requested. "All-input" start states are implicitly enabled on every cycle by simulate().
+ */
+void BitParallelEngine::enableStartStates(bool enableStartOfData) {
+
+    if(!enableStartOfData)
+        return;
+
+    for(uint32_t w = 0; w < num_words; w++) {
+        enabled[w] |= start_of_data_mask[w];
+    }
+}
+
+/**
+ * Simulates a single symbol cycle. Enabled STEs that match the symbol activate, reporting STEs report to the sink unless it is NULL, and the children of all activated STEs are enabled for the next cycle.
+ */
+void BitParallelEngine::simulate(uint8_t symbol, bool end_of_data, uint64_t cycle,
+                                 ReportSink *sink) {
+
+    const uint64_t *match = &match_table[symbol * (size_t)num_words];
+
+    // activate = (enabled | all-input starts) & match; every STE is disabled after matching
+    bool any_active = false;
+    for(uint32_t w = 0; w < num_words; w++) {
+        activated[w] = (enabled[w] | all_input_mask[w]) & match[w];
+        enabled[w] = 0;
+        any_active |= (activated[w] != 0);
+    }
+
+    if(any_active) {
+
+        // report and propagate activation to children
+        for(uint32_t w = 0; w < num_words; w++) {
+
+            uint64_t act = activated[w];
+            if(act == 0)
+                continue;
+
+            if(sink != NULL) {
+                uint64_t reporting = act & report_mask[w];
+                if(end_of_data)
+                    reporting |= act & eod_report_mask[w];
+
+                while(reporting) {
+                    uint32_t i = w * 64 + __builtin_ctzll(reporting);
+                    sink->report(cycle, i);
+                    reporting &= reporting - 1;
+                }
+            }
+
+            while(act) {
+                uint32_t i = w * 64 + __builtin_ctzll(act);
+                for(uint32_t k = succ_offsets[i]; k < succ_offsets[i + 1]; k++) {
+                    enabled[succ_words[k]] |= succ_masks[k];
+                }
+                act &= act - 1;
+            }
+        }
+    }
+
+    // start states are enabled after children, mirroring Automata::simulate
+    enableStartStates(end_of_data);
+}
+
+/**
+ * Disables and deactivates every STE.
+ */
+void BitParallelEngine::reset() {
+
+    fill(enabled.begin(), enabled.end(), 0);
+    fill(activated.begin(), activated.end(), 0);
+}
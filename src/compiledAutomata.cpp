@@ -0,0 +1,132 @@
+/**
+ * @file
+ */
+#include "compiledAutomata.h"
+
+using namespace std;
+
+/**
+ * Flattens the given STEs and special elements into contiguous records. STE indices follow the order of ordered_stes and special element indices follow ordered_specels, which must already be in evaluation order.
+ */
+CompiledAutomata::CompiledAutomata(vector<STE *> &ordered_stes,
+                                   vector<SpecialElement *> &ordered_specels) :
+    specels(ordered_specels),
+    ste_elements(ordered_stes) {
+
+    // assign indices
+    for(uint32_t i = 0; i < ste_elements.size(); i++) {
+        index[ste_elements[i]] = i;
+    }
+
+    for(uint32_t i = 0; i < specels.size(); i++) {
+        index[specels[i]] = i;
+    }
+
+    // levelize special elements and compile the gates
+    gates = new GateNetwork(ste_elements, specels, index);
+
+    // build STE records
+    stes.resize(ste_elements.size());
+    for(uint32_t i = 0; i < ste_elements.size(); i++) {
+
+        STE *s = ste_elements[i];
+        CompiledSTE &c = stes[i];
+
+        bitset<256> column = s->getBitColumn();
+        for(uint32_t w = 0; w < 4; w++) {
+            c.column[w] = 0;
+        }
+        for(uint32_t symbol = 0; symbol < 256; symbol++) {
+            if(column.test(symbol))
+                c.column[symbol >> 6] |= 1ULL << (symbol & 63);
+        }
+
+        c.flags = 0;
+        if(s->startIsAllInput())
+            c.flags |= CSTE_ALL_INPUT;
+        if(s->startIsStartOfData())
+            c.flags |= CSTE_START_OF_DATA;
+        if(s->isReporting())
+            c.flags |= CSTE_REPORTING;
+        if(s->isEod())
+            c.flags |= CSTE_EOD;
+        // gate inputs are raised through the gate network
+        if(gates->getSTETargetsBegin(i) != gates->getSTETargetsEnd(i))
+            c.flags |= CSTE_GATE_CHILDREN;
+        for(auto e : s->getOutputSpecelPointers()) {
+            if(gates->getGate(index[e.first]) == GATE_NONE)
+                c.flags |= CSTE_SPECEL_CHILDREN;
+        }
+
+        if(s->isStart())
+            starts.push_back(i);
+
+        if(s->startIsStartOfData())
+            start_of_data_starts.push_back(i);
+
+        // CSR successor list
+        c.succ_begin = successors.size();
+        for(auto e : s->getOutputSTEPointers()) {
+            successors.push_back(index[e.first]);
+        }
+        c.succ_end = successors.size();
+    }
+
+    // start-of-data starts are re-enabled after an end of data; eod STEs only report on it
+    uses_eod = !start_of_data_starts.empty();
+    for(const CompiledSTE &c : stes) {
+        if((c.flags & CSTE_EOD) && (c.flags & CSTE_REPORTING))
+            uses_eod = true;
+    }
+
+    // index all-input starts by the symbols they match
+    for(uint32_t symbol = 0; symbol < 256; symbol++) {
+        start_dispatch_offsets.push_back(start_dispatch.size());
+        for(uint32_t i : starts) {
+            if((stes[i].flags & CSTE_ALL_INPUT) && stes[i].match(symbol))
+                start_dispatch.push_back(i);
+        }
+    }
+    start_dispatch_offsets.push_back(start_dispatch.size());
+
+    // special element STE successor lists
+    for(SpecialElement *specel : specels) {
+        specel_succ_offsets.push_back(specel_successors.size());
+        for(auto e : specel->getOutputSTEPointers()) {
+            specel_successors.push_back(index[e.first]);
+        }
+    }
+    specel_succ_offsets.push_back(specel_successors.size());
+
+    // report tables by compiled id
+    report_ids.resize(getNumElements());
+    report_codes.resize(getNumElements());
+    for(uint32_t id = 0; id < getNumElements(); id++) {
+        Element *el = getElement(id);
+        if(el->isReporting()) {
+            report_ids[id] = el->getId();
+            report_codes[id] = el->getReportCode();
+        }
+    }
+}
+
+/**
+ *
+ */
+CompiledAutomata::~CompiledAutomata() {
+
+    delete gates;
+}
+
+/**
+ * Looks up the compiled index of an STE or special element. Returns false if the element was not part of the compiled automata.
+ */
+bool CompiledAutomata::getIndex(Element *el, uint32_t *i) {
+
+    unordered_map<Element *, uint32_t>::iterator it = index.find(el);
+    if(it == index.end())
+        return false;
+
+    *i = it->second;
+    return true;
+}
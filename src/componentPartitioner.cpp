@@ -0,0 +1,191 @@
+/**
+ * @file
+ */
+#include "componentPartitioner.h"
+#include "automata.h"
+
+#include <algorithm>
+#include <queue>
+#include <functional>
+
+using namespace std;
+
+// Gauss-Seidel sweeps over a component when propagating enable rates
+#define PARTITION_PROPAGATION_SWEEPS 3
+
+/**
+ * Estimates the cost of every component from its structure alone.
+ */
+ComponentPartitioner::ComponentPartitioner(vector<Automata *> &components) {
+
+    for(Automata *component : components) {
+        costs.push_back(estimateCost(component));
+    }
+}
+
+/**
+ * Takes the cost of every component from the enable and activation counts recorded while profiling cycles symbols of input, e.g. with Automata::getEnabledCount() and Automata::getActivatedCount(). Components are looked up by their Element objects, so the counts may come from the automata the components were split from.
+ */
+ComponentPartitioner::ComponentPartitioner(vector<Automata *> &components,
+                                           unordered_map<Element*, uint32_t> &enabledCount,
+                                           unordered_map<Element*, uint32_t> &activatedCount,
+                                           uint64_t cycles) {
+
+    for(Automata *component : components) {
+        costs.push_back(profiledCost(component, enabledCount, activatedCount, cycles));
+    }
+}
+
+/**
+ * Estimates the work of a component per symbol assuming uniformly distributed input. Enable rates are propagated from the start states in breadth first order: an element is enabled as often as its parents activate, and an STE activates in breadth / 256 of the cycles it is enabled. All-input start states are dispatched by symbol, so they only cost when they match.
+ */
+double ComponentPartitioner::estimateCost(Automata *component) {
+
+    ElementGraph graph(component->getElements());
+
+    // breadth first order from the start states, then whatever is left
+    vector<uint32_t> order;
+    vector<uint8_t> visited(graph.size(), 0);
+    for(STE *start : component->getStarts()) {
+        uint32_t id = graph.getId(start);
+        if(!visited[id]) {
+            visited[id] = 1;
+            order.push_back(id);
+        }
+    }
+
+    for(uint32_t head = 0; head < order.size(); head++) {
+        for(const GraphEdge *e = graph.succBegin(order[head]); e != graph.succEnd(order[head]); e++) {
+            if(!visited[e->node]) {
+                visited[e->node] = 1;
+                order.push_back(e->node);
+            }
+        }
+    }
+
+    for(uint32_t i = 0; i < graph.size(); i++) {
+        if(!visited[i])
+            order.push_back(i);
+    }
+
+    // per element match probability and the always-enabled part of its enable rate
+    vector<double> match(graph.size(), 1.0);
+    vector<double> start(graph.size(), 0.0);
+    for(uint32_t i = 0; i < graph.size(); i++) {
+        Element *el = graph.getElement(i);
+        if(!el->isSpecialElement()) {
+            STE *ste = static_cast<STE *>(el);
+            match[i] = ste->getBitColumn().count() / 256.0;
+            if(ste->startIsAllInput())
+                start[i] = 1.0;
+        }
+    }
+
+    // enable rate from parents; activation rate of each element
+    vector<double> incoming(graph.size(), 0.0);
+    vector<double> active(graph.size(), 0.0);
+    for(uint32_t sweep = 0; sweep < PARTITION_PROPAGATION_SWEEPS; sweep++) {
+        for(uint32_t i : order) {
+            double in = 0.0;
+            for(const GraphEdge *e = graph.predBegin(i); e != graph.predEnd(i); e++) {
+                in += active[e->node];
+            }
+            incoming[i] = min(1.0, in);
+            active[i] = min(1.0, start[i] + incoming[i]) * match[i];
+        }
+    }
+
+    double cost = 0.0;
+    for(uint32_t i = 0; i < graph.size(); i++) {
+        uint32_t fanout = graph.succEnd(i) - graph.succBegin(i);
+        cost += PARTITION_ELEMENT_COST + incoming[i] + active[i] * (1 + fanout);
+    }
+
+    return cost;
+}
+
+/**
+ * Computes the work of a component per symbol from recorded enable and activation counts.
+ */
+double ComponentPartitioner::profiledCost(Automata *component,
+                                          unordered_map<Element*, uint32_t> &enabledCount,
+                                          unordered_map<Element*, uint32_t> &activatedCount,
+                                          uint64_t cycles) {
+
+    uint64_t work = 0;
+    for(auto e : component->getElements()) {
+        Element *el = e.second;
+
+        auto enabled = enabledCount.find(el);
+        if(enabled != enabledCount.end())
+            work += enabled->second;
+
+        auto activated = activatedCount.find(el);
+        if(activated != activatedCount.end())
+            work += (uint64_t)activated->second * (1 + el->getOutputs().size());
+    }
+
+    return component->getElements().size() * PARTITION_ELEMENT_COST + (double)work / max(cycles, (uint64_t)1);
+}
+
+/**
+ * Assigns components to num_threads threads by longest-processing-time bin packing. Returns the thread of every component.
+ */
+vector<uint32_t> ComponentPartitioner::partition(uint32_t num_threads) {
+
+    // most expensive components first; equal costs keep their order
+    vector<uint32_t> order(costs.size());
+    for(uint32_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return costs[a] > costs[b];
+        });
+
+    // least loaded thread first, lowest thread id on ties
+    priority_queue<pair<double, uint32_t>, vector<pair<double, uint32_t>>, greater<pair<double, uint32_t>>> loads;
+    for(uint32_t tid = 0; tid < num_threads; tid++)
+        loads.push(make_pair(0.0, tid));
+
+    vector<uint32_t> assignment(costs.size());
+    for(uint32_t component : order) {
+        pair<double, uint32_t> least = loads.top();
+        loads.pop();
+
+        assignment[component] = least.second;
+        loads.push(make_pair(least.first + costs[component], least.second));
+    }
+
+    return assignment;
+}
+
+/**
+ * Returns the largest thread load of partition(num_threads).
+ */
+double ComponentPartitioner::makespan(uint32_t num_threads) {
+
+    vector<double> loads(num_threads, 0.0);
+    vector<uint32_t> assignment = partition(num_threads);
+    for(uint32_t i = 0; i < assignment.size(); i++)
+        loads[assignment[i]] += costs[i];
+
+    return *max_element(loads.begin(), loads.end());
+}
+
+/**
+ * Picks a thread count for -T auto: the fewest threads, at most max_threads and at most one per component, whose estimated makespan is within PARTITION_AUTO_TOLERANCE of the best. Beyond that point the most expensive components bound the run and more threads only add overhead.
+ */
+uint32_t ComponentPartitioner::chooseNumThreads(uint32_t max_threads) {
+
+    max_threads = min(max_threads, (uint32_t)costs.size());
+    if(max_threads <= 1)
+        return 1;
+
+    double best = makespan(max_threads);
+    for(uint32_t num_threads = 1; num_threads < max_threads; num_threads++) {
+        if(makespan(num_threads) <= best * PARTITION_AUTO_TOLERANCE)
+            return num_threads;
+    }
+
+    return max_threads;
+}
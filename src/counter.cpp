@@ -10,12 +10,10 @@ using namespace MNRL;
  *
  */
 Counter::Counter(string id, uint32_t target, string at_target) : SpecialElement(id), 
-                                                                 mode(PULSE),
-                                                                 dormant(false){
+                                                                 mode(PULSE){
 
     setTarget(target);
     setMode(at_target);
-    value = 0;
 }
 
 /*
@@ -29,50 +27,34 @@ Counter::~Counter() {
 
 
 /**
- * Calculate should return whether or not this element is activated for the next cycle.
+ * Calculate should return whether or not this element is activated for the next cycle. The count value and the dormant and latched flags are kept in state.
  */
-bool Counter::calculate() {
+bool Counter::calculate(SpecialElementState &state) {
 
     bool retval = false;
 
-    // if any inputs are to the cnt input
-    bool count = false;
-    bool reset = false;
-
-    // gather input signals from all ports
-    for(auto i : inputs) {
-        if((i.first.compare(i.first.size() - 4, i.first.size(), ":cnt") == 0) && 
-           i.second == true) {
-
-            // count up
-            count = true;
-
-        } else if((i.first.compare(i.first.size() - 4, i.first.size() - 1, ":rst") == 0) &&
-                  i.second == true) {
-
-            // reset counter
-            reset = true;
-        }  
-    }
+    // if any inputs to the cnt or rst ports are high
+    bool count = state.port_high[PORT_CNT] > 0;
+    bool reset = state.port_high[PORT_RST] > 0;
 
     // reset takes priority over all other signals
     if(reset) {
 
-        dormant = false;
-        latched = false;
-        value = 0;
+        state.dormant = false;
+        state.latched = false;
+        state.value = 0;
         
         // reset is not high, so count if not disabled
-    } else if((count && !dormant) || latched) {
+    } else if((count && !state.dormant) || state.latched) {
         
         // depending on the mode, take action
         if(mode == LATCH) {
-            if(!latched) {
-                value++;
+            if(!state.latched) {
+                state.value++;
             
-                if(value == target) {
+                if(state.value == target) {
                     retval = true;
-                    latched = true;
+                    state.latched = true;
                 }
             } else {
                 retval = true;
@@ -80,24 +62,24 @@ bool Counter::calculate() {
             
         } else if (mode == ROLL) {
             
-            value++;
+            state.value++;
 
-            if(value == target) {
+            if(state.value == target) {
                 retval = true;
 
                 // reset value
-                value = 0;
+                state.value = 0;
             }
             
         } else { // pulse
 
             // count always increases
-            value++;
+            state.value++;
 
-            if(value == target) {
+            if(state.value == target) {
                 retval = true;
                 // set dormant until reset signal is received
-                dormant = true;
+                state.dormant = true;
             }            
         }
     }
@@ -213,41 +195,31 @@ void Counter::setMode(string md) {
 /*
  *
  */
-void Counter::setTarget(uint32_t t) {
-
-    target = t;
-}
-
-/*
- *
- */
-uint32_t Counter::getTarget() {
+string Counter::getMode() {
 
-    return target;
+    if(mode == LATCH) {
+        return "latch";
+    } else if(mode == ROLL) {
+        return "roll";
+    } else {
+        return "pulse";
+    }
 }
 
 /*
  *
  */
-uint32_t Counter::getValue() {
+void Counter::setTarget(uint32_t t) {
 
-    return value;
+    target = t;
 }
 
 /*
  *
  */
-bool Counter::deactivate() {
-
-    bool retval = true;
-
-    if(latched) {
-        retval = false;
-    }else {
-        activated = false;
-    }
+uint32_t Counter::getTarget() {
 
-    return retval;
+    return target;
 }
 
 /*
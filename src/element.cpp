@@ -126,7 +126,7 @@ void Element::setEod(bool isEod) {
 /**
  *
  */
-vector<string> Element::getOutputs() {
+const vector<string> &Element::getOutputs() {
 
     return outputs;
 }
@@ -134,7 +134,7 @@ vector<string> Element::getOutputs() {
 /*
  *
  */
-vector<pair<Element *, string>> Element::getOutputSTEPointers() {
+const vector<pair<Element *, string>> &Element::getOutputSTEPointers() {
 
     return outputSTEPointers;
 }
@@ -142,7 +142,7 @@ vector<pair<Element *, string>> Element::getOutputSTEPointers() {
 /*
  *
  */
-vector<pair<Element *, string>> Element::getOutputSpecelPointers() {
+const vector<pair<Element *, string>> &Element::getOutputSpecelPointers() {
 
     return outputSpecelPointers;
 }
@@ -150,7 +150,7 @@ vector<pair<Element *, string>> Element::getOutputSpecelPointers() {
 /*
  *
  */
-map<string, bool> Element::getInputs() {
+const map<string, bool> &Element::getInputs() {
 
     return inputs;
 }
@@ -161,7 +161,7 @@ map<string, bool> Element::getInputs() {
 bool Element::addOutput(string s) {
 
     // should be idempotent (cannot add edges twice)
-    for(string output : outputs){
+    for(const string &output : outputs){
         if(output.compare(s) == 0){
             return false;
         }
@@ -178,7 +178,7 @@ bool Element::addOutputPointer(pair<Element *, string> el) {
 
     if(el.first->isSpecialElement()){
         // check if it already exists
-        for(auto e : outputSpecelPointers){
+        for(const auto &e : outputSpecelPointers){
             if(e.first == el.first)
                 return false;
         }
@@ -186,7 +186,7 @@ bool Element::addOutputPointer(pair<Element *, string> el) {
         outputSpecelPointers.push_back(el);
     }else{
         // check if it already exists
-        for(auto e : outputSTEPointers){
+        for(const auto &e : outputSTEPointers){
             if(e.first == el.first)
                 return false;
         }
@@ -251,7 +251,7 @@ bool Element::removeOutputPointer(pair<Element *,string> p) {
 
     int position = 0;
     if(p.first->isSpecialElement()){
-        for(pair<Element *, string> el : outputSpecelPointers) {
+        for(const pair<Element *, string> &el : outputSpecelPointers) {
             if(el.first->getId().compare(p.first->getId()) == 0){
                 found = true;
                 break;
@@ -270,7 +270,7 @@ bool Element::removeOutputPointer(pair<Element *,string> p) {
             outputSpecelPointers.pop_back();
         }
     }else{
-        for(pair<Element *, string> el : outputSTEPointers) {
+        for(const pair<Element *, string> &el : outputSTEPointers) {
             if(el.first->getId().compare(p.first->getId()) == 0){
                 found = true;
                 break;
@@ -384,6 +384,37 @@ string Element::getPort(string in) {
     return result;
 }
 
+/**
+ * Returns the port named at the end of a port string (":cnt") or an edge string ("id:cnt"). Anything else enters through PORT_NONE.
+ */
+ElementPort Element::portFromString(const string &in) {
+
+    size_t size = in.size();
+
+    if(size >= 4 && in.compare(size - 4, 4, ":cnt") == 0)
+        return PORT_CNT;
+
+    if(size >= 4 && in.compare(size - 4, 4, ":rst") == 0)
+        return PORT_RST;
+
+    return PORT_NONE;
+}
+
+/**
+ * Returns the port string (":cnt") used in edge strings for port.
+ */
+string Element::portToString(ElementPort port) {
+
+    switch(port) {
+    case PORT_CNT:
+        return ":cnt";
+    case PORT_RST:
+        return ":rst";
+    default:
+        return "";
+    }
+}
+
 /*
  *
  */
@@ -528,6 +559,34 @@ bool Element::identicalOutputs(Element *other) {
     return true;
 }
 
+/**
+ * Returns a hash of the outputs compared by identicalOutputs(). Elements with identical outputs have equal signatures, so merge candidates can be bucketed by signature before they are compared. The order of the outputs does not matter.
+ */
+uint64_t Element::outputSignature() {
+
+    uint64_t keys = 0;
+    for(auto e : getOutputSTEPointers()) {
+        if(e.second.compare(getId()) != 0)
+            keys += hashCombine(0, std::hash<string>()(e.first->getId()));
+    }
+
+    return hashCombine(getOutputSTEPointers().size(), keys);
+}
+
+/**
+ * Returns a hash of the inputs compared by identicalInputs(). Elements with identical inputs have equal signatures.
+ */
+uint64_t Element::inputSignature() {
+
+    uint64_t keys = 0;
+    for(auto e : getInputs()) {
+        if(e.first.compare(getId()) != 0)
+            keys += hashCombine(0, std::hash<string>()(e.first));
+    }
+
+    return hashCombine(getInputs().size(), keys);
+}
+
 /**
  *
  */
@@ -0,0 +1,61 @@
+/**
+ * @file
+ */
+#include "elementGraph.h"
+
+using namespace std;
+
+/**
+ * Numbers all elements densely and builds the successor and predecessor arrays. Output pointers to elements outside of the element map are ignored.
+ */
+ElementGraph::ElementGraph(unordered_map<string, Element *> &elements) {
+
+    // assign dense ids
+    nodes.reserve(elements.size());
+    ids.reserve(elements.size());
+    for(auto &e : elements) {
+        ids[e.second] = nodes.size();
+        nodes.push_back(e.second);
+    }
+
+    uint32_t n = nodes.size();
+
+    // successors, straight from the output pointers
+    succ_offsets.resize(n + 1);
+    for(uint32_t i = 0; i < n; i++) {
+
+        succ_offsets[i] = succ.size();
+        Element *el = nodes[i];
+
+        for(auto &e : el->getOutputSTEPointers()) {
+            auto to = ids.find(e.first);
+            if(to != ids.end())
+                succ.push_back({to->second, PORT_NONE});
+        }
+
+        for(auto &e : el->getOutputSpecelPointers()) {
+            auto to = ids.find(e.first);
+            if(to != ids.end())
+                succ.push_back({to->second, Element::portFromString(e.second)});
+        }
+    }
+    succ_offsets[n] = succ.size();
+
+    // predecessors by counting sort of the successor array
+    pred_offsets.assign(n + 1, 0);
+    for(const GraphEdge &e : succ) {
+        pred_offsets[e.node + 1]++;
+    }
+
+    for(uint32_t i = 0; i < n; i++) {
+        pred_offsets[i + 1] += pred_offsets[i];
+    }
+
+    pred.resize(succ.size());
+    vector<uint32_t> fill(pred_offsets.begin(), pred_offsets.end() - 1);
+    for(uint32_t from = 0; from < n; from++) {
+        for(uint32_t e = succ_offsets[from]; e < succ_offsets[from + 1]; e++) {
+            pred[fill[succ[e].node]++] = {from, succ[e].port};
+        }
+    }
+}
@@ -0,0 +1,185 @@
+/**
+ * @file
+ */
+#include "gateNetwork.h"
+
+using namespace std;
+
+/**
+ * Levelizes the given special elements, which must be in evaluation order, and compiles the gates among them into per-word masks. index maps STEs to their STE index and special elements to their position in specels.
+ */
+GateNetwork::GateNetwork(vector<STE *> &stes,
+                         vector<SpecialElement *> &specels,
+                         unordered_map<Element *, uint32_t> &index) {
+
+    uint32_t n = specels.size();
+
+    // every special element sits one level above its highest special element parent
+    vector<uint32_t> level(n, 0);
+    uint32_t num_levels = 0;
+    for(uint32_t s = 0; s < n; s++) {
+
+        if(level[s] + 1 > num_levels)
+            num_levels = level[s] + 1;
+
+        for(auto &e : specels[s]->getOutputSpecelPointers()) {
+            unordered_map<Element *, uint32_t>::iterator it = index.find(e.first);
+            if(it != index.end() && level[it->second] < level[s] + 1)
+                level[it->second] = level[s] + 1;
+        }
+    }
+
+    // stable counting sort of special elements by level
+    vector<uint32_t> level_offsets(num_levels + 1, 0);
+    for(uint32_t s = 0; s < n; s++) {
+        level_offsets[level[s] + 1]++;
+    }
+    for(uint32_t l = 0; l < num_levels; l++) {
+        level_offsets[l + 1] += level_offsets[l];
+    }
+
+    vector<uint32_t> by_level(n);
+    vector<uint32_t> fill(level_offsets.begin(), level_offsets.end() - 1);
+    for(uint32_t s = 0; s < n; s++) {
+        by_level[fill[level[s]]++] = s;
+    }
+
+    // number gates level by level; each level starts on a new word
+    specel_gate.assign(n, GATE_NONE);
+    level_words.push_back(0);
+    level_others_offsets.push_back(0);
+    num_gates = 0;
+
+    for(uint32_t l = 0; l < num_levels; l++) {
+
+        for(uint32_t k = level_offsets[l]; k < level_offsets[l + 1]; k++) {
+            uint32_t s = by_level[k];
+
+            if(isGateType(specels[s]->getType())) {
+                specel_gate[s] = gate_specel.size();
+                gate_specel.push_back(s);
+                num_gates++;
+            } else {
+                level_others.push_back(s);
+            }
+        }
+
+        while(gate_specel.size() % 64 != 0) {
+            gate_specel.push_back(GATE_NONE);
+        }
+
+        level_words.push_back(gate_specel.size() / 64);
+        level_others_offsets.push_back(level_others.size());
+    }
+
+    // gate type masks
+    uint32_t num_words = gate_specel.size() / 64;
+    and_mask.assign(num_words, 0);
+    or_mask.assign(num_words, 0);
+    nor_mask.assign(num_words, 0);
+    inv_mask.assign(num_words, 0);
+    idle.assign(num_words, 0);
+    gate_num_inputs.assign(gate_specel.size(), 0);
+
+    for(uint32_t g = 0; g < gate_specel.size(); g++) {
+
+        if(gate_specel[g] == GATE_NONE)
+            continue;
+
+        SpecialElement *gate = specels[gate_specel[g]];
+        uint32_t ins = gate->getInputs().size();
+        uint64_t bit = 1ULL << (g & 63);
+        gate_num_inputs[g] = ins;
+
+        // gates without inputs: AND and Inverter stay low, NOR stays high
+        switch(gate->getType()) {
+        case AND_T:
+            if(ins > 0)
+                and_mask[g >> 6] |= bit;
+            break;
+        case OR_T:
+            or_mask[g >> 6] |= bit;
+            break;
+        case NOR_T:
+            nor_mask[g >> 6] |= bit;
+            break;
+        case INVERTER_T:
+            if(ins > 0)
+                inv_mask[g >> 6] |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+
+    for(uint32_t w = 0; w < num_words; w++) {
+        idle[w] = nor_mask[w] | inv_mask[w];
+    }
+
+    // one input per edge into a gate; count edges first
+    vector<uint32_t> input_offsets(gate_specel.size() + 1, 0);
+    for(STE *ste : stes) {
+        for(auto &e : ste->getOutputSpecelPointers()) {
+            uint32_t g = specel_gate[index[e.first]];
+            if(g != GATE_NONE)
+                input_offsets[g + 1]++;
+        }
+    }
+    for(SpecialElement *specel : specels) {
+        for(auto &e : specel->getOutputSpecelPointers()) {
+            uint32_t g = specel_gate[index[e.first]];
+            if(g != GATE_NONE)
+                input_offsets[g + 1]++;
+        }
+    }
+    for(uint32_t g = 0; g < gate_specel.size(); g++) {
+        input_offsets[g + 1] += input_offsets[g];
+    }
+
+    num_inputs = input_offsets.back();
+    input_gate.resize(num_inputs);
+    for(uint32_t g = 0; g < gate_specel.size(); g++) {
+        for(uint32_t i = input_offsets[g]; i < input_offsets[g + 1]; i++) {
+            input_gate[i] = g;
+        }
+    }
+
+    // gate inputs and other special element ports raised by each STE
+    vector<uint32_t> next_input(input_offsets.begin(), input_offsets.end() - 1);
+    for(STE *ste : stes) {
+        ste_target_offsets.push_back(ste_targets.size());
+        ste_port_target_offsets.push_back(ste_port_targets.size());
+        for(auto &e : ste->getOutputSpecelPointers()) {
+            uint32_t s = index[e.first];
+            if(specel_gate[s] != GATE_NONE)
+                ste_targets.push_back(next_input[specel_gate[s]]++);
+            else
+                ste_port_targets.push_back(portTarget(s, Element::portFromString(e.second)));
+        }
+    }
+    ste_target_offsets.push_back(ste_targets.size());
+    ste_port_target_offsets.push_back(ste_port_targets.size());
+
+    // gate inputs and other special element ports raised by each special element
+    for(uint32_t s = 0; s < n; s++) {
+        specel_target_offsets.push_back(specel_targets.size());
+        specel_port_target_offsets.push_back(specel_port_targets.size());
+        for(auto &e : specels[s]->getOutputSpecelPointers()) {
+            uint32_t child = index[e.first];
+            if(specel_gate[child] != GATE_NONE)
+                specel_targets.push_back(next_input[specel_gate[child]]++);
+            else
+                specel_port_targets.push_back(portTarget(child, Element::portFromString(e.second)));
+        }
+    }
+    specel_target_offsets.push_back(specel_targets.size());
+    specel_port_target_offsets.push_back(specel_port_targets.size());
+}
+
+/**
+ * Returns true for the special element types compiled into the gate network.
+ */
+bool GateNetwork::isGateType(ElementType type) {
+
+    return type == AND_T || type == OR_T || type == NOR_T || type == INVERTER_T;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file
+ */
+#include "inputReader.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/**
+ * Opens fn for chunked reading, or stdin if fn is "-". If use_mmap is set and fn is a non-empty regular file, the file is memory mapped instead of read into buffers.
+ */
+InputReader::InputReader(string fn, uint64_t chunk_size, bool use_mmap) :
+    chunk_size(chunk_size),
+    bytes_read(0),
+    next_buffer(0),
+    map(NULL),
+    map_size(0) {
+
+    buffers[0] = NULL;
+    buffers[1] = NULL;
+
+    if(fn.compare("-") == 0) {
+        fd = STDIN_FILENO;
+    }else{
+        fd = open(fn.c_str(), O_RDONLY);
+        if(fd < 0) {
+            inputFileCheck();
+            cout << "VAsim Error: could not open input file." << endl;
+            exit(-1);
+        }
+    }
+
+    // map regular files if requested
+    struct stat st;
+    if(use_mmap && fd != STDIN_FILENO && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(m != MAP_FAILED) {
+            map = (uint8_t *)m;
+            map_size = st.st_size;
+            madvise(map, map_size, MADV_SEQUENTIAL);
+        }
+    }
+
+    if(map == NULL) {
+        buffers[0] = (uint8_t *)malloc(chunk_size);
+        buffers[1] = (uint8_t *)malloc(chunk_size);
+    }
+}
+
+/**
+ * Unmaps or frees all input buffers and closes the input file.
+ */
+InputReader::~InputReader() {
+
+    if(map != NULL)
+        munmap(map, map_size);
+
+    free(buffers[0]);
+    free(buffers[1]);
+
+    if(fd != STDIN_FILENO)
+        close(fd);
+}
+
+/**
+ * Points chunk at the next chunk of input and returns its length, or 0 at the end of the input. Chunks are chunk_size bytes except for the last. A chunk stays valid until read() has been called twice more. Exits if the input cannot be read.
+ */
+uint64_t InputReader::read(uint8_t **chunk) {
+
+    // memory mapped input
+    if(map != NULL) {
+        uint64_t length = min(chunk_size, map_size - bytes_read);
+        *chunk = map + bytes_read;
+        bytes_read += length;
+        return length;
+    }
+
+    // fill a whole buffer; pipes may return short reads
+    uint8_t *buffer = buffers[next_buffer];
+    next_buffer ^= 1;
+
+    uint64_t length = 0;
+    while(length < chunk_size) {
+        ssize_t n = ::read(fd, buffer + length, chunk_size - length);
+        if(n < 0) {
+            if(errno == EINTR)
+                continue;
+            // a partial scan must not look like a complete one
+            cout << "VAsim Error: could not read input: " << strerror(errno) << endl;
+            exit(-1);
+        }
+        if(n == 0)
+            break;
+        length += n;
+    }
+
+    *chunk = buffer;
+    bytes_read += length;
+    return length;
+}
@@ -24,19 +24,10 @@ Inverter::~Inverter() {
 /*
  *
  */
-bool Inverter::calculate() {
+bool Inverter::calculate(SpecialElementState &state) {
 
-    bool result = false;
-    
-    for(auto ins: inputs) {
-
-        if(ins.second == false) {
-            result = true;
-        }
-
-    }
-
-    return result;
+    // true if any input is low
+    return getNumHighInputs(state) < getNumInputs();
 }
 
 /*
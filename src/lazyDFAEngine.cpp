@@ -0,0 +1,280 @@
+/**
+ * @file
+ */
+#include "lazyDFAEngine.h"
+
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * Creates an empty transition cache over the given compiled automata. The cache is flushed whenever its estimated size exceeds max_memory bytes.
+ */
+LazyDFAEngine::LazyDFAEngine(CompiledAutomata *compiled, uint64_t max_memory) :
+    compiled(compiled),
+    max_memory(max_memory),
+    memory(0),
+    current(-1),
+    caching(true),
+    hits(0),
+    misses(0),
+    flushes(0),
+    states_created(0),
+    symbols_since_flush(0) {
+
+    mark.assign(compiled->getNumSTEs(), 0);
+
+    // start in the state with no explicitly enabled STEs
+    reset();
+}
+
+/**
+ * Frees all cached states.
+ */
+LazyDFAEngine::~LazyDFAEngine() {
+
+    for(DFAState *s : states)
+        delete s;
+}
+
+/**
+ * Returns the id of the DFA state for the given sorted STE set, creating the state if it has not been seen since the last flush.
+ */
+uint32_t LazyDFAEngine::internState(vector<uint32_t> &set) {
+
+    unordered_map<vector<uint32_t>, uint32_t, STESetHash>::iterator it = state_ids.find(set);
+    if(it != state_ids.end())
+        return it->second;
+
+    uint32_t id = states.size();
+    it = state_ids.insert(make_pair(set, id)).first;
+
+    DFAState *s = new DFAState;
+    s->set = &(it->first);
+    for(uint32_t symbol = 0; symbol < 256; symbol++) {
+        s->transitions[symbol].next = -1;
+    }
+    states.push_back(s);
+
+    // state record, its key in the hash table and the table node
+    memory += sizeof(DFAState) + sizeof(DFAState *) + set.size() * sizeof(uint32_t) + 64;
+    states_created++;
+
+    return id;
+}
+
+/**
+ * Drops every cached state and transition, keeping only the current state. If the cache was flushed after fewer than ten symbols per cached state it is not paying for itself, and the engine stops caching.
+ */
+void LazyDFAEngine::flush() {
+
+    if(current >= 0)
+        current_set = *(states[current]->set);
+
+    if(symbols_since_flush < 10 * (uint64_t)states.size())
+        caching = false;
+
+    for(DFAState *s : states)
+        delete s;
+    states.clear();
+    state_ids.clear();
+    report_pool.clear();
+    memory = 0;
+
+    flushes++;
+    symbols_since_flush = 0;
+
+    if(caching) {
+        current = internState(current_set);
+    }else{
+        current = -1;
+    }
+}
+
+/**
+ * Computes one NFA step from the given set of enabled STEs. Leaves the sorted next enabled set in next_set and the sorted STEs that report on this step in step_reports.
+ */
+void LazyDFAEngine::step(const vector<uint32_t> &enabled, uint8_t symbol, bool end_of_data) {
+
+    const uint32_t *successors = compiled->getSuccessors();
+    activated.clear();
+
+    // enabled STEs that match the symbol
+    for(uint32_t index : enabled) {
+        if(compiled->getSTE(index).match(symbol)) {
+            mark[index] = 1;
+            activated.push_back(index);
+        }
+    }
+
+    // all-input starts are implicitly enabled
+    const uint32_t *end = compiled->getAllInputStartsEnd(symbol);
+    for(const uint32_t *start = compiled->getAllInputStartsBegin(symbol); start != end; start++) {
+        if(!mark[*start]) {
+            mark[*start] = 1;
+            activated.push_back(*start);
+        }
+    }
+
+    // reports
+    step_reports.clear();
+    for(uint32_t index : activated) {
+        mark[index] = 0;
+
+        uint32_t flags = compiled->getSTE(index).flags;
+        if((flags & CSTE_REPORTING) && (!(flags & CSTE_EOD) || end_of_data))
+            step_reports.push_back(index);
+    }
+
+    // reports of a cycle are sent in STE index order
+    sort(step_reports.begin(), step_reports.end());
+
+    // children of activated STEs and, after end of data, start-of-data starts
+    next_set.clear();
+    for(uint32_t index : activated) {
+        const CompiledSTE &s = compiled->getSTE(index);
+        for(uint32_t k = s.succ_begin; k < s.succ_end; k++) {
+            uint32_t child = successors[k];
+            if(!mark[child]) {
+                mark[child] = 1;
+                next_set.push_back(child);
+            }
+        }
+    }
+
+    if(end_of_data) {
+        for(uint32_t index : compiled->getStartOfDataStarts()) {
+            if(!mark[index]) {
+                mark[index] = 1;
+                next_set.push_back(index);
+            }
+        }
+    }
+
+    for(uint32_t index : next_set)
+        mark[index] = 0;
+
+    sort(next_set.begin(), next_set.end());
+}
+
+/**
+ * Sends a report for each reporting STE index in [begin, end) to the sink. A NULL sink drops the reports.
+ */
+void LazyDFAEngine::emitReports(const uint32_t *begin, const uint32_t *end, uint64_t cycle,
+                                ReportSink *sink) {
+
+    if(sink == NULL)
+        return;
+
+    for(const uint32_t *r = begin; r != end; r++) {
+        sink->report(cycle, *r);
+    }
+}
+
+/**
+ * Enables all "start-of-data" start states if requested. "All-input" start states are implicitly enabled on every cycle.
+ */
+void LazyDFAEngine::enableStartStates(bool enableStartOfData) {
+
+    if(!enableStartOfData)
+        return;
+
+    vector<uint32_t> set = (current >= 0) ? *(states[current]->set) : current_set;
+    set.insert(set.end(),
+               compiled->getStartOfDataStarts().begin(),
+               compiled->getStartOfDataStarts().end());
+    sort(set.begin(), set.end());
+    set.erase(unique(set.begin(), set.end()), set.end());
+
+    if(caching) {
+        current = internState(set);
+    }else{
+        current_set = set;
+    }
+}
+
+/**
+ * Simulates a single symbol cycle. Cached transitions assume that end of data is signaled exactly on '\n' symbols; the final symbol of the input is therefore stepped through the NFA but never cached.
+ */
+void LazyDFAEngine::simulate(uint8_t symbol, bool end_of_data, uint64_t cycle,
+                             ReportSink *sink) {
+
+    symbols_since_flush++;
+
+    bool cacheable = (end_of_data == (symbol == '\n'));
+
+    if(caching) {
+
+        // hit
+        Transition &t = states[current]->transitions[symbol];
+        if(cacheable && t.next >= 0) {
+            hits++;
+            emitReports(report_pool.data() + t.reports_begin,
+                        report_pool.data() + t.reports_end,
+                        cycle, sink);
+            current = t.next;
+            return;
+        }
+
+        // miss
+        misses++;
+        if(memory > max_memory)
+            flush();
+    }
+
+    // flushing may have disabled caching
+    if(!caching) {
+        step(current_set, symbol, end_of_data);
+        emitReports(step_reports.data(), step_reports.data() + step_reports.size(), cycle, sink);
+        current_set.swap(next_set);
+        return;
+    }
+
+    step(*(states[current]->set), symbol, end_of_data);
+    uint32_t next = internState(next_set);
+
+    if(cacheable) {
+        Transition &t = states[current]->transitions[symbol];
+        t.reports_begin = report_pool.size();
+        report_pool.insert(report_pool.end(), step_reports.begin(), step_reports.end());
+        t.reports_end = report_pool.size();
+        t.next = next;
+        memory += step_reports.size() * sizeof(uint32_t);
+    }
+
+    emitReports(step_reports.data(), step_reports.data() + step_reports.size(), cycle, sink);
+    current = next;
+}
+
+/**
+ * Disables every STE. Cached states and transitions are kept, so a reset engine starts warm.
+ */
+void LazyDFAEngine::reset() {
+
+    current_set.clear();
+    if(caching) {
+        current = internState(current_set);
+    }else{
+        current = -1;
+    }
+}
+
+/**
+ * Prints cache hit, miss and flush counters to stdout.
+ */
+void LazyDFAEngine::printStatistics() {
+
+    uint64_t lookups = hits + misses;
+
+    cout << "Lazy DFA Statistics: " << endl;
+    cout << "  Cache Hits: " << hits << endl;
+    cout << "  Cache Misses: " << misses << endl;
+    cout << "  Hit Rate: " << (lookups == 0 ? 0.0 : (double)hits / (double)lookups) << endl;
+    cout << "  Cache Flushes: " << flushes << endl;
+    cout << "  DFA States Created: " << states_created << endl;
+    cout << "  Cached States: " << states.size() << endl;
+    cout << "  Cache Memory: " << memory << " / " << max_memory << " bytes" << endl;
+    if(!caching)
+        cout << "  Caching disabled after an unproductive flush; fell back to NFA stepping" << endl;
+}
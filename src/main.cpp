@@ -1,4 +1,8 @@
 #include "automata.h"
+#include "inputReader.h"
+#include "reportWriter.h"
+#include "componentPartitioner.h"
+#include "workStealingScheduler.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -14,14 +18,21 @@ using namespace std;
 
 void usage(char * argv) {
 
-    printf("USAGE: %s [OPTIONS] <automata anml> <input file/string> \n", argv);
+    printf("USAGE: %s [OPTIONS] <automata anml> <input file/string> [<input file> ...]\n", argv);
     printf("  -i, --input               Input chars are taken from command line\n");
     printf("  -t, --time                Time simulation\n");
     printf("  -r, --report              Print reports to stdout\n");
     printf("  -b, --batchsim            Output report mimics format of batchsim\n");
+    printf("      --report-format=<name> Format of report files: \"text\" (default) or \"binary\". Report files are written while simulating\n");
+    printf("      --merge-reports       Merge the reports of all threads into a single report file ordered by cycle\n");
     printf("  -q, --quiet               Suppress all non-debugging output\n");
     printf("  -p, --profile             Profiles automata, storing activation and enable histograms in .out files\n");
     printf("  -c, --charset             Compute charset complexity of automata using Quine-McCluskey Algorithm\n");
+    printf("  -s, --stream              Stream input in chunks instead of loading it into memory. Input file \"-\" reads stdin\n");
+    printf("      --chunk-size=<int>    Size of streamed input chunks in KB (default 1024)\n");
+    printf("      --mmap                Memory map regular input files when streaming\n");
+    printf("      --engine=<name>       Simulation engine: \"nfa\" (default), \"bitparallel\" or \"lazydfa\" (STE-only automata)\n");
+    printf("      --dfa-cache=<int>     Memory budget of the lazy DFA transition cache in MB (default 64)\n");
 
     printf("\n DEBUG:\n");
     printf("      --dump-state=<int>    Prints state of automata on cycle <int> to stes_<cycle>.state and specels_<cycle>.state files.\n");
@@ -30,8 +41,10 @@ void usage(char * argv) {
     printf("  -d, --dot                 Output automata as dot file. Builds a heat map if profiling is turned on\n");
     printf("  -a, --anml                Output automata as anml file. Useful for storing graphs after long running optimizations\n");
     printf("  -m, --mnrl                Output automata as MNRL file. Useful for storing graphs after long running optimizations\n");
+    printf("      --binary              Output automata as binary .vab file. Loads much faster than anml or MNRL\n");
     printf("  -n, --nfa                 Output automata as nfa readable by Michela Becchi's tools\n");    
     printf("  -D, --dfa                 Convert automata to DFA\n");
+    printf("      --dfa-max-states=<int> Keep the NFA of subgraphs whose DFA would have more than <int> states (default 1048576)\n");
     printf("  -f, --hdl                 Output automata as one-hot encoded verilog HDL for execution on an FPGA (EXPERIMENTAL)\n");    
     printf("  -B, --blif                Output automata as .blif circuit for place-and-route using VPR.\n");
     printf("      --graph               Output automata as .graph file for HyperScan.\n");
@@ -39,6 +52,7 @@ void usage(char * argv) {
     printf("\n OPTIMIZATIONS:\n");    
     printf("  -O, --optimize-global     Run all optimizations on all automata subgraphs.\n");
     printf("  -L, --optimize-logal      Run all optimizations on automata subgraphs after partitioned among parallel threads.\n");
+    printf("      --optimize-components Run all optimizations on every connected component before components are partitioned among threads. Components are optimized in parallel on -T threads\n");
     printf("  -x, --remove_ors          Remove all OR gates. Only applied globally.\n");
 
     printf("\n TRANSFORMATIONS:\n");
@@ -48,8 +62,12 @@ void usage(char * argv) {
     printf("      --2-stride             Two strides automata if possible.\n");
     
     printf("\n MULTITHREADING:\n");
-    printf("  -T, --threads             Specify number of threads to compute connected components of automata\n");
-    printf("  -P, --packets             Specify number of threads to compute input stream. NOT SAFE. TODO: allow for overlap between packets\n");
+    printf("  -T, --threads             Specify number of threads to compute connected components of automata. \"auto\" picks the number of threads from the estimated cost of the components\n");
+    printf("      --cost-sample=<int>   Estimate the cost of connected components by profiling the first <int> KB of input\n");
+    printf("  -P, --packets             Specify number of threads to compute input stream. Slices are simulated speculatively and reconciled in order\n");
+    printf("      --scheduler=<name>    Thread scheduling: \"threads\" (default) runs one thread per subgraph and packet; \"steal\" splits every input file into blocks and runs (subgraph, block) tasks on -T work-stealing workers. Extra input files are scanned as independent streams\n");
+    printf("      --block-size=<int>    Size of the input blocks scheduled by the work-stealing scheduler in KB (default 64)\n");
+    printf("      --interleave=<int>    Number of input streams the work-stealing scheduler simulates in lockstep per subgraph group to overlap their memory accesses (default 1)\n");
 
     printf("\n MISC:\n");
     printf("  -h, --help                Print this help and exit\n");
@@ -59,8 +77,203 @@ void usage(char * argv) {
 /*
  *
  */
-void simulateAutomaton(Automata *a, uint8_t *input, uint64_t start_index, uint64_t sim_length, uint64_t total_length) {
-    a->simulate(input, start_index, sim_length, total_length);
+void simulateAutomaton(Automata *a, SimulationContext *ctx, uint8_t *input, uint64_t start_index, uint64_t sim_length, uint64_t total_length, string engine) {
+
+    if(engine.compare("bitparallel") == 0) {
+        a->simulateBitParallel(*ctx, input, start_index, sim_length, total_length);
+    } else if(engine.compare("lazydfa") == 0) {
+        a->simulateLazyDFA(*ctx, input, start_index, sim_length, total_length);
+    } else {
+        a->simulate(*ctx, input, start_index, sim_length, total_length);
+    }
+}
+
+/*
+ *
+ */
+void simulateAutomatonChunk(Automata *a, uint8_t *chunk, uint64_t length, bool end_of_input) {
+
+    a->simulateChunk(chunk, length, end_of_input);
+}
+
+/*
+ * Stitches the speculatively simulated input slices of one automata together in input order. Each slice is corrected using the true end state of the slice before it, so the reports of all slices together are identical to a single sequential run.
+ */
+void reconcilePackets(Automata *a, SimulationContext **packets, uint32_t num_packets, uint8_t *input, uint64_t size) {
+
+    uint64_t packet_size = size / num_packets;
+
+    for(uint32_t packet = 1; packet < num_packets; packet++) {
+
+        // Handle odd divisors
+        uint64_t length = packet_size;
+        if(packet == num_packets - 1)
+            length += size % num_packets;
+
+        a->reconcileSlice(*packets[packet], *packets[packet - 1], input, packet * packet_size, length, size);
+    }
+}
+
+/*
+ * Hands the reconciled reports of all input packets of one automata to their report sinks in input order.
+ */
+void writePacketReports(SimulationContext **packets, ReportSink **sinks, uint32_t num_packets) {
+
+    for(uint32_t packet = 0; packet < num_packets; packet++) {
+        for(const Report &r : packets[packet]->getReports()) {
+            sinks[packet]->report(r.cycle, r.element);
+        }
+        sinks[packet]->advance(packets[packet]->getCycle());
+    }
+}
+
+/*
+ * Input streams simulated together by one automata on the work-stealing scheduler, each in its own context.
+ */
+struct StreamGroup {
+    Automata *automata;
+    vector<SimulationContext*> contexts;
+    vector<uint8_t*> inputs;
+    vector<uint64_t> sizes;
+};
+
+/*
+ * Returns a task simulating the input blocks starting at start of a group of streams, in lockstep if there are several. The task spawns the next blocks of the group when it is done, so blocks stay in input order while other automata and stream groups run on other workers.
+ */
+SchedulerTask blockTask(StreamGroup *group, uint64_t start, uint64_t block_size) {
+
+    return [=](WorkStealingScheduler &scheduler, uint32_t worker) {
+        uint32_t k = group->contexts.size();
+        SimulationContext *ctxs[k];
+        uint8_t *blocks[k];
+        uint64_t lengths[k];
+        bool ends[k];
+
+        // streams that still have input
+        uint32_t n = 0;
+        bool more = false;
+        for(uint32_t s = 0; s < k; s++) {
+            if(start >= group->sizes[s])
+                continue;
+
+            if(start == 0)
+                group->automata->initializeSimulation(*group->contexts[s], true);
+
+            ctxs[n] = group->contexts[s];
+            blocks[n] = group->inputs[s] + start;
+            lengths[n] = min(block_size, group->sizes[s] - start);
+            ends[n] = (start + lengths[n] == group->sizes[s]);
+            more |= !ends[n];
+            n++;
+        }
+
+        if(n == 1)
+            group->automata->simulateChunk(*ctxs[0], blocks[0], lengths[0], ends[0]);
+        else
+            group->automata->simulateInterleaved(ctxs, blocks, lengths, ends, n);
+
+        if(more)
+            scheduler.spawn(worker, blockTask(group, start + block_size, block_size));
+    };
+}
+
+/*
+ * Simulates every input stream with every automata on num_workers work-stealing workers. contexts holds num_streams contexts per automata. The streams of an automata are simulated interleave at a time in lockstep. Returns the number of steals.
+ */
+uint64_t scheduleSimulation(Automata **automata, SimulationContext **contexts, uint32_t num_automata, vector<uint8_t*> &inputs, vector<uint64_t> &sizes, uint64_t block_size, uint32_t interleave, uint32_t num_workers) {
+
+    WorkStealingScheduler scheduler(num_workers);
+    uint32_t num_streams = inputs.size();
+    vector<StreamGroup> groups;
+
+    for(uint32_t i = 0; i < num_automata; i++) {
+        // compile before workers share the automata
+        automata[i]->getCompiledAutomata();
+
+        for(uint32_t s = 0; s < num_streams; s++) {
+            if(sizes[s] == 0)
+                continue;
+
+            if(groups.empty() || groups.back().automata != automata[i] || groups.back().contexts.size() == interleave) {
+                groups.push_back(StreamGroup());
+                groups.back().automata = automata[i];
+            }
+
+            groups.back().contexts.push_back(contexts[i * num_streams + s]);
+            groups.back().inputs.push_back(inputs[s]);
+            groups.back().sizes.push_back(sizes[s]);
+        }
+    }
+
+    for(StreamGroup &group : groups) {
+        scheduler.push(blockTask(&group, 0, block_size));
+    }
+
+    scheduler.run();
+
+    return scheduler.getNumSteals();
+}
+
+/*
+ * Runs task(i) for every i below n on num_workers work-stealing workers. Tasks run in index order if there is only one worker. Every task must only touch its own automata.
+ */
+void parallelFor(uint32_t n, uint32_t num_workers, const function<void(uint32_t)> &task) {
+
+    if(num_workers <= 1 || n <= 1) {
+        for(uint32_t i = 0; i < n; i++)
+            task(i);
+        return;
+    }
+
+    WorkStealingScheduler scheduler(min(num_workers, n));
+    for(uint32_t i = 0; i < n; i++) {
+        scheduler.push([&task, i](WorkStealingScheduler &, uint32_t) {
+                task(i);
+            });
+    }
+
+    scheduler.run();
+}
+
+/*
+ * Streams input from fn through all automata chunk by chunk. Each automata keeps its state across chunks. The next chunk is read while the current one is simulated; the last symbol of each chunk is held back until we know whether it ends the input. Returns the number of symbols simulated.
+ */
+uint64_t simulateStream(vector<Automata*> &automata, string fn, uint64_t chunk_size, bool use_mmap) {
+
+    InputReader reader(fn, chunk_size, use_mmap);
+
+    for(Automata *a : automata) {
+        a->initializeSimulation();
+    }
+
+    uint8_t *chunk;
+    uint64_t length = reader.read(&chunk);
+
+    while(length > 0) {
+
+        // simulate all but the last symbol
+        vector<thread> threads;
+        for(Automata *a : automata) {
+            threads.push_back(thread(simulateAutomatonChunk, a, chunk, length - 1, false));
+        }
+
+        uint8_t *next_chunk;
+        uint64_t next_length = reader.read(&next_chunk);
+
+        for(thread &t : threads) {
+            t.join();
+        }
+
+        // the last symbol ends the input if nothing follows it
+        for(Automata *a : automata) {
+            a->simulateChunk(chunk + length - 1, 1, next_length == 0);
+        }
+
+        chunk = next_chunk;
+        length = next_length;
+    }
+
+    return reader.getBytesRead();
 }
 
 /*
@@ -78,6 +291,7 @@ int main(int argc, char * argv[]) {
     bool to_dot = false;
     bool to_anml = false;
     bool to_mnrl = false;
+    bool to_binary = false;
     bool time = false;
     bool optimize_global = false;
     bool prefix_merge_global = false;
@@ -87,12 +301,16 @@ int main(int argc, char * argv[]) {
     bool common_path_merge_global = false;
     bool common_path_merge_local = false;
     bool optimize_local = false;
+    bool optimize_components = false;
     bool remove_ors = false;
     bool to_nfa = false;
     bool to_dfa = false;
+    uint32_t dfa_max_states = DFA_DEFAULT_MAX_STATES;
     bool to_hdl = false;
     bool to_blif = false;
     uint32_t num_threads = 1;
+    bool auto_threads = false;
+    uint64_t cost_sample = 0;
     uint32_t num_threads_packets = 1;
     bool to_graph = false;
     int32_t fanin_limit = -1;
@@ -101,6 +319,16 @@ int main(int argc, char * argv[]) {
     uint32_t dump_state_cycle = 0;
     bool widen = false;
     bool two_stride = false;
+    string engine = "nfa";
+    uint64_t dfa_cache_size = LAZY_DFA_DEFAULT_CACHE_SIZE;
+    bool stream = false;
+    uint64_t chunk_size = INPUT_READER_DEFAULT_CHUNK_SIZE;
+    bool use_mmap = false;
+    ReportFormat report_format = REPORT_FORMAT_TEXT;
+    bool merge_reports = false;
+    bool steal = false;
+    uint64_t block_size = SCHEDULER_DEFAULT_BLOCK_SIZE;
+    uint32_t interleave = 1;
     
     // long option switches
     const int32_t graph_switch = 1000;
@@ -109,6 +337,19 @@ int main(int argc, char * argv[]) {
     const int32_t dump_state_switch = 1003;
     const int32_t widen_switch = 1004;
     const int32_t two_stride_switch = 1005;
+    const int32_t engine_switch = 1006;
+    const int32_t dfa_cache_switch = 1007;
+    const int32_t chunk_size_switch = 1008;
+    const int32_t mmap_switch = 1009;
+    const int32_t binary_switch = 1010;
+    const int32_t report_format_switch = 1011;
+    const int32_t merge_reports_switch = 1012;
+    const int32_t cost_sample_switch = 1013;
+    const int32_t scheduler_switch = 1014;
+    const int32_t block_size_switch = 1015;
+    const int32_t interleave_switch = 1016;
+    const int32_t optimize_components_switch = 1017;
+    const int32_t dfa_max_states_switch = 1018;
     
     int c;
     const char * short_opt = "thsqrbnfcdBDeamxipOLT:P:";
@@ -140,6 +381,20 @@ int main(int argc, char * argv[]) {
         {"dump-state",         required_argument, NULL, dump_state_switch},
         {"widen",         no_argument, NULL, widen_switch},
         {"2-stride",         no_argument, NULL, two_stride_switch},
+        {"engine",         required_argument, NULL, engine_switch},
+        {"dfa-cache",         required_argument, NULL, dfa_cache_switch},
+        {"stream",         no_argument, NULL, 's'},
+        {"chunk-size",         required_argument, NULL, chunk_size_switch},
+        {"mmap",         no_argument, NULL, mmap_switch},
+        {"binary",         no_argument, NULL, binary_switch},
+        {"report-format",         required_argument, NULL, report_format_switch},
+        {"merge-reports",         no_argument, NULL, merge_reports_switch},
+        {"cost-sample",         required_argument, NULL, cost_sample_switch},
+        {"scheduler",         required_argument, NULL, scheduler_switch},
+        {"block-size",         required_argument, NULL, block_size_switch},
+        {"interleave",         required_argument, NULL, interleave_switch},
+        {"optimize-components",         no_argument, NULL, optimize_components_switch},
+        {"dfa-max-states",         required_argument, NULL, dfa_max_states_switch},
         {NULL,            0,           NULL, 0  }
     };
     
@@ -191,6 +446,10 @@ int main(int argc, char * argv[]) {
             charset_complexity = true;
             break;
 
+        case 's':
+            stream = true;
+            break;
+
         case 'O':
             prefix_merge_global = true;
             suffix_merge_global = true;
@@ -211,7 +470,10 @@ int main(int argc, char * argv[]) {
             break;
 
         case 'T':
-            num_threads = atoi(optarg);
+            if(string(optarg).compare("auto") == 0)
+                auto_threads = true;
+            else
+                num_threads = atoi(optarg);
             break;
 
         case 'P':
@@ -275,6 +537,100 @@ int main(int argc, char * argv[]) {
         case two_stride_switch:
             two_stride = true;
             break;
+
+        case engine_switch:
+            engine = optarg;
+            if(engine.compare("nfa") != 0 && engine.compare("bitparallel") != 0 && engine.compare("lazydfa") != 0){
+                cout << "Error: Unknown simulation engine " << engine << endl;
+                exit(1);
+            }
+            break;
+
+        case dfa_cache_switch:
+            if(atoi(optarg) < 1){
+                cout << "Error: DFA cache size cannot be less than 1 MB" << endl;
+                exit(1);
+            }
+            dfa_cache_size = (uint64_t)atoi(optarg) * 1024 * 1024;
+            break;
+
+        case chunk_size_switch:
+            if(atoi(optarg) < 1){
+                cout << "Error: Chunk size cannot be less than 1 KB" << endl;
+                exit(1);
+            }
+            chunk_size = (uint64_t)atoi(optarg) * 1024;
+            break;
+
+        case mmap_switch:
+            use_mmap = true;
+            break;
+
+        case binary_switch:
+            to_binary = true;
+            break;
+
+        case report_format_switch:
+            if(string(optarg).compare("text") == 0){
+                report_format = REPORT_FORMAT_TEXT;
+            }else if(string(optarg).compare("binary") == 0){
+                report_format = REPORT_FORMAT_BINARY;
+            }else{
+                cout << "Error: Unknown report format " << optarg << endl;
+                exit(1);
+            }
+            break;
+
+        case merge_reports_switch:
+            merge_reports = true;
+            break;
+
+        case cost_sample_switch:
+            if(atoi(optarg) < 1){
+                cout << "Error: Cost sample cannot be less than 1 KB" << endl;
+                exit(1);
+            }
+            cost_sample = (uint64_t)atoi(optarg) * 1024;
+            break;
+
+        case scheduler_switch:
+            if(string(optarg).compare("threads") == 0){
+                steal = false;
+            }else if(string(optarg).compare("steal") == 0){
+                steal = true;
+            }else{
+                cout << "Error: Unknown scheduler " << optarg << endl;
+                exit(1);
+            }
+            break;
+
+        case block_size_switch:
+            if(atoi(optarg) < 1){
+                cout << "Error: Block size cannot be less than 1 KB" << endl;
+                exit(1);
+            }
+            block_size = (uint64_t)atoi(optarg) * 1024;
+            break;
+
+        case interleave_switch:
+            if(atoi(optarg) < 1){
+                cout << "Error: Cannot interleave less than 1 stream" << endl;
+                exit(1);
+            }
+            interleave = atoi(optarg);
+            break;
+
+        case optimize_components_switch:
+            optimize_components = true;
+            break;
+
+        case dfa_max_states_switch:
+            if(atoi(optarg) < 1){
+                cout << "Error: DFA cannot have less than 1 state" << endl;
+                exit(1);
+            }
+            dfa_max_states = atoi(optarg);
+            break;
             
         default:
             fprintf(stderr, "%s: invalid option -- %c\n", argv[0], c);
@@ -291,6 +647,7 @@ int main(int argc, char * argv[]) {
     
     // Parse command line args
     string fn(argv[optind++]);
+    string input_fn;
     uint8_t *input;
     uint64_t size;
 
@@ -298,6 +655,8 @@ int main(int argc, char * argv[]) {
 
     if(optind >= argc) {
         simulate = false;
+    }else{
+        input_fn = argv[optind];
     }
 
     // Parse Input
@@ -314,7 +673,44 @@ int main(int argc, char * argv[]) {
     }
 
 
-    if(simulate){
+    // streamed input is read during simulation
+    if(input_string)
+        stream = false;
+
+    if(stream && num_threads_packets > 1){
+        cout << "Error: Streaming input cannot be split into packets" << endl;
+        exit(1);
+    }
+
+    if(steal && stream){
+        cout << "Error: Streaming input cannot be scheduled in blocks" << endl;
+        exit(1);
+    }
+
+    if(steal && num_threads_packets > 1){
+        cout << "Error: Input packets cannot be combined with the work-stealing scheduler" << endl;
+        exit(1);
+    }
+
+    if(steal && engine.compare("nfa") != 0){
+        if(!quiet)
+            cout << "VASim WARNING: The work-stealing scheduler is only supported by the default engine. Falling back to default engine." << endl;
+        engine = "nfa";
+    }
+
+    if(stream && engine.compare("nfa") != 0){
+        if(!quiet)
+            cout << "VASim WARNING: Streaming input is only supported by the default engine. Falling back to default engine." << endl;
+        engine = "nfa";
+    }
+
+    input = NULL;
+    size = 0;
+
+    if(simulate && stream){
+        if(!quiet)
+            cout << "  Streaming input in " << chunk_size / 1024 << " KB chunks" << endl << endl;
+    }else if(simulate){
         // Parse automata input file or input from command line
         input = parseInputStream(simulate, input_string, &size, argv, optind);
         
@@ -334,6 +730,32 @@ int main(int argc, char * argv[]) {
         }
     }
 
+    // the work-stealing scheduler scans every input file as its own stream
+    vector<uint8_t*> stream_inputs;
+    vector<uint64_t> stream_sizes;
+    if(simulate && steal){
+        stream_inputs.push_back(input);
+        stream_sizes.push_back(size);
+
+        if(!input_string){
+            for(int arg = optind + 1; arg < argc; arg++) {
+                uint64_t stream_size = 0;
+                uint8_t *stream_input = parseInputStream(simulate, input_string, &stream_size, argv, arg);
+
+                if(!quiet)
+                    cout << "  Found " << stream_size << " input symbols in " << argv[arg] << "." << endl;
+
+                stream_inputs.push_back(stream_input);
+                stream_sizes.push_back(stream_size);
+            }
+        }
+    }
+
+    // every input packet needs at least one symbol
+    if(simulate && !stream && num_threads_packets > size){
+        num_threads_packets = size;
+    }
+
     // Build automata
     if(!quiet){
      
@@ -352,6 +774,20 @@ int main(int argc, char * argv[]) {
     uint32_t orig_automata_size = ap.getElements().size();
 
     ap.setQuiet(quiet);
+
+    // input slices can only be reconciled on the default engine
+    if(num_threads_packets > 1 && engine.compare("nfa") != 0){
+        if(!quiet)
+            cout << "VASim WARNING: Input packets are only supported by the default engine. Falling back to default engine." << endl;
+        engine = "nfa";
+    }
+
+    // merged streams wait for each other, which blocked workers cannot do
+    if(steal && merge_reports){
+        if(!quiet)
+            cout << "VASim WARNING: Reports cannot be merged with the work-stealing scheduler. Writing one report file per subgraph group and stream." << endl;
+        merge_reports = false;
+    }
     
     
     if(!quiet){
@@ -383,6 +819,24 @@ int main(int argc, char * argv[]) {
         
     }
 
+    // Profile a prefix of the input to measure the activity of every subgraph.
+    // The sample runs in its own context, so the real simulation is not disturbed
+    SimulationContext *sample = NULL;
+    uint64_t sample_length = 0;
+    if(cost_sample > 0 && simulate && !stream){
+        if(!quiet)
+            cout << "Profiling the first " << min(size, cost_sample) << " input symbols..." << endl;
+
+        sample_length = min(size, cost_sample);
+        sample = ap.newSimulationContext();
+        ap.setQuiet(true);
+        ap.setProfile(true);
+        ap.initializeSimulation(*sample, true);
+        ap.simulateChunk(*sample, input, sample_length, sample_length == size);
+        ap.setProfile(false);
+        ap.setQuiet(quiet);
+    }
+
     // Partition automata into connected components
     if(!quiet)
         cout << "Finding connected components..." << endl;
@@ -393,6 +847,62 @@ int main(int argc, char * argv[]) {
     if(!quiet)
         cout << endl;
 
+    // components and subgraph groups are independent, so they are preprocessed on -T threads
+    uint32_t num_preprocess_threads = auto_threads ? max(thread::hardware_concurrency(), 1u) : max(num_threads, 1u);
+
+    // Optimize every component on its own before components are merged
+    if(optimize_components) {
+        if(!quiet){
+            cout << "|-----------------------------|" << endl;
+            cout << "|   Component Optimizations   |" << endl;
+            cout << "|-----------------------------|" << endl;
+
+            cout << "Optimizing " << ccs.size() << " subgraphs on " << min(num_preprocess_threads, (uint32_t)ccs.size()) << " thread(s)..." << endl;
+        }
+
+        uint32_t components_size = 0;
+        for(Automata *cc : ccs)
+            components_size += cc->getElements().size();
+
+        parallelFor(ccs.size(), num_preprocess_threads, [&](uint32_t i) {
+                ccs[i]->setQuiet(true);
+                ccs[i]->optimize(false, // never do or gate removal locally
+                                 true,
+                                 true,
+                                 true);
+                ccs[i]->setQuiet(quiet);
+            });
+
+        if(!quiet){
+            uint32_t optimized_size = 0;
+            for(Automata *cc : ccs)
+                optimized_size += cc->getElements().size();
+
+            cout << "  Reduced " << components_size << " elements to " << optimized_size << "!" << endl;
+            cout << endl;
+        }
+    }
+
+    // Estimate the cost of every subgraph
+    ComponentPartitioner *partitioner;
+    if(sample != NULL){
+        partitioner = new ComponentPartitioner(ccs, sample->getEnabledCount(), sample->getActivatedCount(), sample_length);
+        delete sample;
+    }else{
+        partitioner = new ComponentPartitioner(ccs);
+    }
+
+    if(auto_threads){
+        num_threads = partitioner->chooseNumThreads(max(thread::hardware_concurrency(), 1u));
+    }
+
+    // the work-stealing scheduler runs -T workers over more, smaller groups of subgraphs
+    uint32_t num_workers = num_threads;
+    if(steal){
+        num_threads = min(num_workers * SCHEDULER_GROUPS_PER_WORKER, (uint32_t)ccs.size());
+        num_threads_packets = max((uint32_t)stream_inputs.size(), 1u);
+    }
+
     // Combine connected components into N automata
     if(!quiet)
         cout << "Distributing " << ccs.size() << " distinct subgraphs among " << num_threads << " threads..." << endl;
@@ -407,18 +917,28 @@ int main(int argc, char * argv[]) {
         num_threads = ccs.size();
     }
 
-    unsigned int counter = 0;
+    // Balance the estimated cost of the subgraphs among threads
+    vector<uint32_t> assignment = partitioner->partition(num_threads);
+    vector<double> thread_costs(num_threads, 0.0);
     vector<Automata*> merged(num_threads);
-    for(Automata *a : ccs) {
+    for(uint32_t i = 0; i < ccs.size(); i++) {
+
+        uint32_t tid = assignment[i];
+        thread_costs[tid] += partitioner->getCost(i);
 
-        if(merged[counter % num_threads] == NULL){
-            merged[counter % num_threads] = ccs[counter];
+        if(merged[tid] == NULL){
+            merged[tid] = ccs[i];
         }else{
-            merged[counter % num_threads]->unsafeMerge(a);
-            merged[counter % num_threads]->copyFlagsFrom(a);
+            merged[tid]->unsafeMerge(ccs[i]);
+            merged[tid]->copyFlagsFrom(ccs[i]);
         }
+    }
+
+    delete partitioner;
 
-        counter++;
+    if(!quiet && num_threads > 1){
+        for(uint32_t tid = 0; tid < num_threads; tid++)
+            cout << "  Thread " << tid << ": estimated cost " << thread_costs[tid] << endl;
     }
 
     // finalize copied automata
@@ -431,7 +951,9 @@ int main(int argc, char * argv[]) {
     
     // Preprocess all automata partitions
     // Set up multi-dimensional structure for parallelization
-    Automata *automata[num_threads][num_threads_packets];
+    // All input packets of an automata share its graph, each with its own simulation context
+    Automata *automata[num_threads];
+    SimulationContext *contexts[num_threads][num_threads_packets];
     
     
 
@@ -443,14 +965,25 @@ int main(int argc, char * argv[]) {
         }
     }
 
-    counter = 0;
-    for(Automata *a : merged) {        
+    // messages of groups preprocessed in parallel would interleave, so only the summary is printed
+    uint32_t num_group_threads = min(num_preprocess_threads, num_threads);
+    bool verbose = !quiet && num_group_threads <= 1;
+    if(!quiet && !verbose)
+        cout << "Preprocessing " << num_threads << " subgraph groups on " << num_group_threads << " threads..." << endl << endl;
+
+    // output files are named by group, whichever thread finishes first
+    parallelFor(num_threads, num_group_threads, [&](uint32_t counter) {
+
+        Automata *a = merged[counter];
+        if(!verbose)
+            a->setQuiet(true);
+
         /*********************
          * LOCAL OPTIMIZATIONS
          *********************/     
         // Optimize after connected component merging
         if(optimize_local) {
-            if(!quiet)
+            if(verbose)
                 cout << "Starting Local Optimizations for Thread " << counter << "..." << endl; 
 
             //
@@ -462,7 +995,7 @@ int main(int argc, char * argv[]) {
 
         // Enforce fan-in limit
         if(fanin_limit > 0){
-            if(!quiet){
+            if(verbose){
                 cout << "Enforcing fan-in of " << fanin_limit << "..." << endl; 
                 cout << endl;
             }
@@ -473,7 +1006,7 @@ int main(int argc, char * argv[]) {
 
         // Enforce fan-out limit
         if(fanout_limit > 0){
-            if(!quiet){
+            if(verbose){
                 cout << "Enforcing fan-out of " << fanout_limit << "..." << endl; 
                 cout << endl;
             }
@@ -483,7 +1016,7 @@ int main(int argc, char * argv[]) {
 
         // Widen
         if(widen){
-            if(!quiet) {
+            if(verbose) {
                 cout<< "Widening automata..." <<endl;
                 cout<<endl;
             }
@@ -492,27 +1025,36 @@ int main(int argc, char * argv[]) {
 
         // 2-Stride
         if(two_stride){
-            if(!quiet) {
+            if(verbose) {
                 cout<< "2-Striding automata..." << endl;
             }
             Automata *strided = a->twoStrideAutomata();
             delete a;
             a = strided;
-            if(!quiet){
+            if(verbose){
                 cout << "  Done!" << endl << endl;
+            }else{
+                a->setQuiet(true);
             }
 
         }
         
         // Convert automata to DFA
         if(to_dfa) {
-            if(!quiet) {
+            if(verbose) {
                 cout<< "Converting automata to DFA..." <<endl;
                 cout<<endl;
             }
             
-            Automata * dfa = a->generateDFA();
-            a = dfa;
+            Automata * dfa = a->generateDFA(dfa_max_states);
+            if(dfa == NULL){
+                if(!quiet)
+                    cout << "VASim WARNING: DFA of subgraph group " << counter << " exceeds " << dfa_max_states << " states. Keeping the NFA." << endl;
+            }else{
+                a = dfa;
+                if(!verbose)
+                    a->setQuiet(true);
+            }
         }
 
         /*******************
@@ -528,6 +1070,11 @@ int main(int argc, char * argv[]) {
             a->automataToMNRLFile("automata_" + to_string(counter) + ".mnrl");
         }
 
+        // Save automata binary if desired
+        if(to_binary) {
+            a->automataToBinaryFile("automata_" + to_string(counter) + "." + BINARY_AUTOMATA_EXTENSION);
+        }
+
         // Emit in Becchi format NFA
         if(to_nfa){
             a->automataToNFAFile("automata_" + to_string(counter) + ".nfa");
@@ -540,36 +1087,38 @@ int main(int argc, char * argv[]) {
 
         // Emit as .blif circuit file
         if(to_blif){
-            if(!quiet)
+            if(verbose)
                 cout << "Emitting automata as .blif circuit..." << endl << endl;
             a->automataToBLIFFile("automata_" + to_string(counter) + ".blif");
         }
 
         // Emit as graph file readable by augmented HyperScan
         if(to_graph){
-            if(!quiet)
+            if(verbose)
                 cout << "Emitting automata in .graph format for HyperScan ingestion..." << endl << endl;
             a->automataToGraphFile("automata_" + to_string(counter) + ".graph");
         }
 
-        // Save each parallel automata and replicate for multiple streams
-        // *** TODO: this is a lazy way of avoiding writing a copy constructor
-        const char * tmp_fn = "temp_vasim_unique_temp_file_name.anml"; 
-        a->automataToANMLFile(tmp_fn);
-        
-        // Insert automata into correct index for multiple input streams
-        automata[counter][0] = a;
+        if(!verbose)
+            a->setQuiet(quiet);
+
+        merged[counter] = a;
+    });
+
+    for(uint32_t counter = 0; counter < num_threads; counter++) {
+
+        Automata *a = merged[counter];
+
+        // Insert automata into correct index and give every extra input packet its own context
+        automata[counter] = a;
+        contexts[counter][0] = &a->getSimulationContext();
         for (int packet = 1; packet < num_threads_packets; ++packet) {
-            automata[counter][packet] = new Automata(tmp_fn);
+            contexts[counter][packet] = a->newSimulationContext();
         }
-        // Delete temp file
-        remove(tmp_fn);
 
         // Print final stats
 	if(!quiet)
             a->printGraphStats();
-
-        counter++;
     }
 
     /****************************
@@ -578,15 +1127,56 @@ int main(int argc, char * argv[]) {
     if(!quiet){
         if(num_threads == 1){
             // Compressability
-            cout << "Compressability: " << 1.0 - ((double)automata[0][0]->getElements().size()/(double)orig_automata_size) << endl;
+            cout << "Compressability: " << 1.0 - ((double)automata[0]->getElements().size()/(double)orig_automata_size) << endl;
             
             // STE complexity
             if(charset_complexity)
-                automata[0][0]->printSTEComplexity();
+                automata[0]->printSTEComplexity();
             cout << endl;
         }
     }
 
+    /****************************
+     * REPORT FILES
+     ***************************/
+    // Report files are written by a writer thread, one stream per context,
+    // or one stream per thread merged into a single file. Reports of input
+    // packets are only final once reconciled, so only contexts of unsplit
+    // input report to the writer while simulating
+    ReportWriter *writer = NULL;
+    ReportSink *sinks[num_threads][num_threads_packets];
+    if(report && !batchsim) {
+        writer = new ReportWriter(report_format);
+        string extension = (report_format == REPORT_FORMAT_BINARY) ? BINARY_REPORT_EXTENSION : "txt";
+
+        uint32_t merged_output = 0;
+        if(merge_reports)
+            merged_output = writer->addOutput("reports." + extension);
+
+        for (int tid = 0; tid < num_threads; tid++) {
+            for(int packet = 0; packet < num_threads_packets; packet++) {
+                CompiledAutomata *compiled = automata[tid]->getCompiledAutomata();
+
+                if(merge_reports) {
+                    // packets of a thread are consecutive, so they share its stream
+                    if(packet == 0)
+                        sinks[tid][packet] = writer->addStream(merged_output, compiled);
+                    else
+                        sinks[tid][packet] = sinks[tid][0];
+                }else{
+                    string reportFile = "reports_" +
+                        to_string(tid) + "tid_" +
+                        to_string(packet) + (steal ? "stream." : "packet.") + extension;
+                    sinks[tid][packet] = writer->addStream(reportFile, compiled);
+                }
+
+                if(num_threads_packets == 1 || steal)
+                    contexts[tid][packet]->setReportSink(sinks[tid][packet]);
+            }
+        }
+        writer->start();
+    }
+
     /****************************
      * SIMULATION
      ***************************/
@@ -595,7 +1185,10 @@ int main(int argc, char * argv[]) {
             cout << "|------------------------|" << endl;
             cout << "|       Simulation       |" << endl;
             cout << "|------------------------|" << endl;
-            cout << "Starting simulation using " << num_threads << "x" << num_threads_packets << "=" << num_threads*num_threads_packets << " thread(s)..." << endl; 
+            if(steal)
+                cout << "Scheduling " << num_threads << " subgraph group(s) x " << num_threads_packets << " stream(s) on " << num_workers << " worker(s)..." << endl;
+            else
+                cout << "Starting simulation using " << num_threads << "x" << num_threads_packets << "=" << num_threads*num_threads_packets << " thread(s)..." << endl; 
         }
         thread threads[num_threads][num_threads_packets];
 
@@ -606,16 +1199,53 @@ int main(int argc, char * argv[]) {
         }
         
         // Simulate all automata
-        for (int tid = 0; tid < num_threads; tid++) {
-            //for(Automata *a : merged) {
+        if(stream) {
 
-            uint64_t packet_offset = 0;              
-            uint64_t packet_size = size/num_threads_packets;              
-            // For each input packet of the input stream
-            //for (int tid= 0; tid < num_threads; tid++) {
-            for(int packet = 0; packet < num_threads_packets; packet++) {
+            // streaming keeps one automata per thread alive across chunks
+            vector<Automata*> streamed;
+            for (int tid = 0; tid < num_threads; tid++) {
+                Automata *a = automata[tid];
+                a->setProfile(profile);
+                a->setDumpState(dump_state, dump_state_cycle);
+                a->setReport(report);
+                streamed.push_back(a);
+            }
+
+            size = simulateStream(streamed, input_fn, chunk_size, use_mmap);
 
-                Automata *a = automata[tid][packet];
+            if(!quiet) {
+                cout << "\x1B[2K"; // Erase the entire current line.
+                cout << "\x1B[0E";  // Move to the beginning of the current line.
+                cout << "  Progress: " << size << " / " << size << endl;
+            }
+
+        } else if(steal) {
+
+            // progress of concurrent blocks would interleave
+            for (int tid = 0; tid < num_threads; tid++) {
+                Automata *a = automata[tid];
+                a->setProfile(profile);
+                a->setDumpState(dump_state, dump_state_cycle);
+                a->setReport(report);
+                a->setQuiet(true);
+            }
+
+            uint64_t steals = scheduleSimulation(automata, &contexts[0][0], num_threads, stream_inputs, stream_sizes, block_size, interleave, num_workers);
+
+            // throughput counts every stream
+            size = 0;
+            for(uint64_t stream_size : stream_sizes)
+                size += stream_size;
+
+            if(!quiet)
+                cout << "  Scanned " << size << " input symbols, " << steals << " task(s) stolen" << endl;
+
+        } else {
+
+            for (int tid = 0; tid < num_threads; tid++) {
+                //for(Automata *a : merged) {
+
+                Automata *a = automata[tid];
 
                 /***************************
                  * RUNTIME FLAGS
@@ -630,33 +1260,56 @@ int main(int argc, char * argv[]) {
                 // enable report gathering
                 a->setReport(report);
 
-                // Handle odd divisors
-                uint64_t length = packet_size;
-                if(packet == num_threads_packets - 1)
-                    length += size % packet_size;
-
-                //cout << "Launching thread:" << endl;
-                //cout << "  packet: " << packet << endl;
-                //cout << "  packet_offset: " << packet_offset << endl;
-                //cout << "  length: " << length << endl;
-                //cout << "  packet_size: " << packet_size << endl;
-
-                // Launch thread
-                threads[tid][packet] = thread(simulateAutomaton, 
-                                              a,
-                                              input,
-                                              packet_offset,
-                                              length, 
-                                              size);
+                // lazy DFA memory budget
+                a->setLazyDFACacheSize(dfa_cache_size);
+
+                uint64_t packet_offset = 0;              
+                uint64_t packet_size = size/num_threads_packets;              
+                // For each input packet of the input stream
+                //for (int tid= 0; tid < num_threads; tid++) {
+                for(int packet = 0; packet < num_threads_packets; packet++) {
+
+                    // Handle odd divisors
+                    uint64_t length = packet_size;
+                    if(packet == num_threads_packets - 1)
+                        length += size % num_threads_packets;
+
+                    //cout << "Launching thread:" << endl;
+                    //cout << "  packet: " << packet << endl;
+                    //cout << "  packet_offset: " << packet_offset << endl;
+                    //cout << "  length: " << length << endl;
+                    //cout << "  packet_size: " << packet_size << endl;
+
+                    // Launch thread
+                    threads[tid][packet] = thread(simulateAutomaton, 
+                                                  a,
+                                                  contexts[tid][packet],
+                                                  input,
+                                                  packet_offset,
+                                                  length, 
+                                                  size,
+                                                  engine);
             
-                packet_offset += packet_size;
+                    packet_offset += packet_size;
+                }
             }
-        }
 
-        // Join threads
-        for (int i = 0; i < num_threads; ++i) {
-            for(int j = 0; j < num_threads_packets; j++){
-                threads[i][j].join();
+            // Join threads
+            for (int i = 0; i < num_threads; ++i) {
+                for(int j = 0; j < num_threads_packets; j++){
+                    threads[i][j].join();
+                }
+            }
+
+            // Stitch input packets together in order
+            if(num_threads_packets > 1) {
+                for (int tid = 0; tid < num_threads; tid++) {
+                    threads[tid][0] = thread(reconcilePackets, automata[tid], &contexts[tid][0], num_threads_packets, input, size);
+                }
+
+                for (int tid = 0; tid < num_threads; tid++) {
+                    threads[tid][0].join();
+                }
             }
         }
 
@@ -666,6 +1319,16 @@ int main(int argc, char * argv[]) {
             double duration = chrono::duration<double, std::milli>(end_time - start_time).count();
             std::cout << "Simulation Time: " << duration << " ms" << std::endl;
             std::cout << "Throughput: " << (size/1000)/(duration) << " MB/s" << std::endl;
+
+            // lazy DFA cache behavior
+            for (int tid = 0; tid < num_threads; tid++) {
+                LazyDFAEngine *dfa = automata[tid]->getLazyDFAEngine();
+                if(dfa != NULL) {
+                    if(num_threads > 1)
+                        std::cout << "Thread " << tid << ": ";
+                    dfa->printStatistics();
+                }
+            }
         }
     }
      
@@ -677,39 +1340,60 @@ int main(int argc, char * argv[]) {
     for (int tid= 0; tid < num_threads; tid++) {
         for(int packet = 0; packet < num_threads_packets; packet++) {
             
-            Automata *a = automata[tid][packet];
+            Automata *a = automata[tid];
+            SimulationContext *ctx = contexts[tid][packet];
             
             // quiet supresses all non-debug output
-            if(report){
+            if(report && batchsim){
                 // number of reports
-                num_reports += a->getReportVector().size();
+                num_reports += ctx->getReports().size();
 
                 // number of reporting cycles
-                uint32_t cur = 0;
-                for(auto e : a->getReportVector()) {
-                    if(e.first != cur){
+                uint64_t cur = 0;
+                for(const Report &r : ctx->getReports()) {
+                    if(r.cycle != cur){
                         match_cycles++;
-                        cur = e.first;
+                        cur = r.cycle;
                     }
                 }
 
-                if(batchsim){
-                    a->printReportBatchSim();
-                }else{
-                    //a->printReport();
-                    string reportFile = "reports_" +
-                        to_string(tid) + "tid_" +
-                        to_string(packet) + "packet.txt";
- 
-                    a->writeReportToFile(reportFile);
-                    //e.parseTraceFile(reportFile);
-                }
+                a->printReportBatchSim(*ctx);
 
             }
             
         }
     }       
 
+    // hand reconciled packet reports to the writer; merged streams wait
+    // for each other, so every thread needs its own producer
+    if(writer != NULL && num_threads_packets > 1 && !steal && simulate) {
+        thread threads[num_threads];
+        for (int tid = 0; tid < num_threads; tid++) {
+            threads[tid] = thread(writePacketReports, &contexts[tid][0], &sinks[tid][0], num_threads_packets);
+        }
+
+        for (int tid = 0; tid < num_threads; tid++) {
+            threads[tid].join();
+        }
+    }
+
+    // wait for all report files to be written
+    if(writer != NULL) {
+        writer->finish();
+
+        for(uint32_t output = 0; output < writer->getNumOutputs(); output++) {
+            num_reports += writer->getNumReports(output);
+            match_cycles += writer->getNumReportingCycles(output);
+        }
+
+        // the writer owns the sinks of the contexts
+        for (int tid = 0; tid < num_threads; tid++) {
+            contexts[tid][0]->setReportSink(NULL);
+        }
+
+        delete writer;
+    }
+
     if(report && !quiet && simulate) {
 
         cout << "|------------------------|" << endl;
@@ -725,8 +1409,8 @@ int main(int argc, char * argv[]) {
     // Emit heatmap dot graphs
     for (int tid= 0; tid < num_threads; tid++) {
         
-        // Remember, the y direction are identical, so only need y = 0
-        Automata *a = automata[tid][0];
+        // heatmaps come from the automata's own context
+        Automata *a = automata[tid];
         
         // print graphviz
         // this is done after simulation to account for addition of profiling metadata (e.g. heatmaps)
@@ -736,7 +1420,18 @@ int main(int argc, char * argv[]) {
         
     }
 
+    for (int tid = 0; tid < num_threads; tid++) {
+        for (int packet = 1; packet < num_threads_packets; packet++) {
+            delete contexts[tid][packet];
+        }
+    }
+
+    // input buffers come from malloc in parseInputStream()
     if(simulate){
-        delete input;
+        free(input);
+    }
+
+    for(uint32_t s = 1; s < stream_inputs.size(); s++) {
+        free(stream_inputs[s]);
     }
 }
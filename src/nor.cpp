@@ -23,18 +23,10 @@ NOR::~NOR() {
 /*
  * DOES NOR OPERATION OVER INPUTS
  */
-bool NOR::calculate() {
+bool NOR::calculate(SpecialElementState &state) {
 
-    bool result = false;
-    
-
-    for(auto e : inputs) {
-        result = result || e.second;
-    }
-
-    // above code was copied from OR
     // simply invert OR op
-    return (!result);
+    return getNumHighInputs(state) == 0;
 }
 
 /*
@@ -23,16 +23,10 @@ OR::~OR() {
 /*
  * DOES OR OPERATION OVER INPUTS
  */
-bool OR::calculate() {
+bool OR::calculate(SpecialElementState &state) {
 
-    bool result = false;
-    
-
-    for(auto e : inputs) {
-        result = result || e.second;
-    }
-
-    return result;
+    // any input high
+    return getNumHighInputs(state) > 0;
 }
 
 /*
@@ -0,0 +1,58 @@
+/**
+ * @file
+ */
+#include "prefilter.h"
+
+#include <string.h>
+
+using namespace std;
+
+/**
+ * Collects the union charset of all-input start STEs. '\n' is added if the automata has start-of-data STEs, because they are re-enabled after every end-of-data symbol.
+ */
+Prefilter::Prefilter(CompiledAutomata *compiled) {
+
+    num_stop_symbols = 0;
+    first_stop_symbol = 0;
+
+    for(uint32_t symbol = 0; symbol < 256; symbol++) {
+
+        stop[symbol] = compiled->getAllInputStartsBegin(symbol) != compiled->getAllInputStartsEnd(symbol);
+        if(symbol == '\n' && !compiled->getStartOfDataStarts().empty())
+            stop[symbol] = 1;
+
+        if(stop[symbol]) {
+            if(num_stop_symbols == 0)
+                first_stop_symbol = symbol;
+            num_stop_symbols++;
+        }
+    }
+}
+
+/**
+ * Returns the offset of the first symbol in inputs[start, end) that may activate a start state, or end if there is none. Uses memchr when only one symbol can stop the scan.
+ */
+uint64_t Prefilter::scan(const uint8_t *inputs, uint64_t start, uint64_t end) const {
+
+    if(num_stop_symbols == 0)
+        return end;
+
+    if(num_stop_symbols == 1) {
+        const void *found = memchr(inputs + start, first_stop_symbol, end - start);
+        return (found == NULL) ? end : (const uint8_t *)found - inputs;
+    }
+
+    // table lookup, four symbols at a time
+    uint64_t i = start;
+    for(; i + 4 <= end; i += 4) {
+        if(stop[inputs[i]] | stop[inputs[i + 1]] | stop[inputs[i + 2]] | stop[inputs[i + 3]])
+            break;
+    }
+
+    for(; i < end; i++) {
+        if(stop[inputs[i]])
+            return i;
+    }
+
+    return end;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file
+ */
+#include "reportSink.h"
+
+#include <thread>
+
+using namespace std;
+
+/*
+ *
+ */
+ReportSink::~ReportSink() {
+
+}
+
+/**
+ * Does nothing. Sinks that hand reports to other threads publish the cycle.
+ */
+void ReportSink::advance(uint64_t cycle) {
+
+}
+
+/**
+ * Appends the report.
+ */
+void ReportVectorSink::report(uint64_t cycle, uint32_t element) {
+
+    reports.push_back({cycle, element});
+}
+
+/**
+ * Constructs a sink that calls callback(cycle, element) for every report.
+ */
+CallbackReportSink::CallbackReportSink(function<void(uint64_t, uint32_t)> callback) : callback(callback) {
+
+}
+
+/**
+ * Calls the callback.
+ */
+void CallbackReportSink::report(uint64_t cycle, uint32_t element) {
+
+    callback(cycle, element);
+}
+
+/**
+ *
+ */
+CountingReportSink::CountingReportSink() {
+
+    clear();
+}
+
+/**
+ * Counts the report, and its cycle if it is the first report of that cycle.
+ */
+void CountingReportSink::report(uint64_t cycle, uint32_t element) {
+
+    if(num_reports == 0 || cycle != last_cycle)
+        num_cycles++;
+
+    last_cycle = cycle;
+    num_reports++;
+}
+
+/**
+ * Resets all counts to zero.
+ */
+void CountingReportSink::clear() {
+
+    num_reports = 0;
+    num_cycles = 0;
+    last_cycle = 0;
+}
+
+/**
+ * Constructs an empty ring buffer. The capacity is rounded up to a power of two.
+ */
+RingBufferReportSink::RingBufferReportSink(uint64_t capacity) : head(0), tail(0), watermark(0) {
+
+    uint64_t size = 1;
+    while(size < capacity)
+        size <<= 1;
+
+    buffer.resize(size);
+    mask = size - 1;
+}
+
+/**
+ * Appends the report, waiting for the consumer while the buffer is full.
+ */
+void RingBufferReportSink::report(uint64_t cycle, uint32_t element) {
+
+    uint64_t t = tail.load(memory_order_relaxed);
+
+    while(t - head.load(memory_order_acquire) == buffer.size())
+        this_thread::yield();
+
+    buffer[t & mask] = {cycle, element};
+    tail.store(t + 1, memory_order_release);
+}
+
+/**
+ * Publishes that all reports before cycle are in the buffer or have been consumed.
+ */
+void RingBufferReportSink::advance(uint64_t cycle) {
+
+    watermark.store(cycle, memory_order_release);
+}
+
+/**
+ * Copies the oldest report into r without removing it. Returns false if the buffer is empty.
+ */
+bool RingBufferReportSink::peek(Report &r) {
+
+    uint64_t h = head.load(memory_order_relaxed);
+
+    if(h == tail.load(memory_order_acquire))
+        return false;
+
+    r = buffer[h & mask];
+    return true;
+}
+
+/**
+ * Removes the oldest report into r. Returns false if the buffer is empty.
+ */
+bool RingBufferReportSink::pop(Report &r) {
+
+    uint64_t h = head.load(memory_order_relaxed);
+
+    if(h == tail.load(memory_order_acquire))
+        return false;
+
+    r = buffer[h & mask];
+    head.store(h + 1, memory_order_release);
+    return true;
+}
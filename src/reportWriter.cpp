@@ -0,0 +1,333 @@
+/**
+ * @file
+ */
+#include "reportWriter.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * Constructs a writer with the default ring and buffer sizes.
+ */
+ReportWriter::ReportWriter(ReportFormat format) :
+    ReportWriter(format, REPORT_WRITER_DEFAULT_RING_SIZE, REPORT_WRITER_DEFAULT_BUFFER_SIZE) {
+
+}
+
+/**
+ * Constructs a writer. Every stream buffers up to ring_size reports between its simulation thread and the writer thread, and up to buffer_size bytes of formatted output before writing to its file.
+ */
+ReportWriter::ReportWriter(ReportFormat format, uint64_t ring_size, uint64_t buffer_size) :
+    format(format),
+    ring_size(ring_size),
+    buffer_size(buffer_size),
+    done(false),
+    running(false) {
+
+}
+
+/**
+ * Finishes writing if the writer is still running and closes all report files.
+ */
+ReportWriter::~ReportWriter() {
+
+    finish();
+
+    for(Output *o : outputs) {
+        close(o->fd);
+        delete o;
+    }
+
+    for(Stream *s : streams) {
+        delete s;
+    }
+}
+
+/**
+ * Creates report file fn and returns its output index.
+ */
+uint32_t ReportWriter::addOutput(string fn) {
+
+    Output *o = new Output;
+    o->num_reports = 0;
+    o->num_cycles = 0;
+    o->last_cycle = 0;
+    o->buffer.reserve(buffer_size + 256);
+
+    o->fd = open(fn.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(o->fd < 0) {
+        cout << "VAsim Error: could not open report file " << fn << "." << endl;
+        exit(-1);
+    }
+
+    outputs.push_back(o);
+
+    return outputs.size() - 1;
+}
+
+/**
+ * Adds a stream to an output and returns the sink its simulation thread reports to. Compiled ids are resolved through compiled, which must not change until finish() returns.
+ */
+ReportSink *ReportWriter::addStream(uint32_t output, const CompiledAutomata *compiled) {
+
+    Output *o = outputs[output];
+
+    Stream *s = new Stream(ring_size);
+    s->compiled = compiled;
+    s->base = 0;
+    if(!o->streams.empty())
+        s->base = o->streams.back()->base + o->streams.back()->compiled->getNumElements();
+
+    o->streams.push_back(s);
+    streams.push_back(s);
+
+    return &s->sink;
+}
+
+/**
+ * Adds a stream with its own report file fn.
+ */
+ReportSink *ReportWriter::addStream(string fn, const CompiledAutomata *compiled) {
+
+    return addStream(addOutput(fn), compiled);
+}
+
+/**
+ * Starts the writer thread.
+ */
+void ReportWriter::start() {
+
+    if(running)
+        return;
+
+    if(format == REPORT_FORMAT_BINARY) {
+        for(Output *o : outputs) {
+            appendBinaryHeader(o);
+        }
+    }
+
+    done.store(false, memory_order_release);
+    running = true;
+    writer = thread(&ReportWriter::run, this);
+}
+
+/**
+ * Waits until the writer thread has written all reports of all streams. Must only be called once no simulation thread reports anymore.
+ */
+void ReportWriter::finish() {
+
+    if(!running)
+        return;
+
+    done.store(true, memory_order_release);
+    writer.join();
+    running = false;
+}
+
+/**
+ * Writer thread. Drains all outputs round robin until finish() is called and a full pass finds every ring empty, then writes what is left in the buffers.
+ */
+void ReportWriter::run() {
+
+    while(true) {
+
+        // reports sent before finish() are visible once done is
+        bool last = done.load(memory_order_acquire);
+
+        uint64_t drained = 0;
+        for(Output *o : outputs) {
+            drained += drain(o, last);
+        }
+
+        if(drained == 0) {
+            if(last)
+                break;
+
+            // nothing to do, give the simulation threads time to report
+            this_thread::sleep_for(chrono::microseconds(100));
+        }
+    }
+
+    for(Output *o : outputs) {
+        flush(o);
+    }
+}
+
+/**
+ * Writes all reports of output o that are known to come next, writing the buffer whenever it is full. Reports are ordered by (cycle, stream). An idle stream may still report any cycle from its watermark on, so a report is held back while some idle stream could report before it; once last is set no stream reports anymore. Returns the number of reports written.
+ */
+uint64_t ReportWriter::drain(Output *o, bool last) {
+
+    uint64_t drained = 0;
+    uint32_t num_streams = o->streams.size();
+
+    while(true) {
+
+        // find the streams with the smallest and second smallest next key;
+        // an idle stream's key is its watermark, so it is never written
+        pair<uint64_t, uint32_t> first(UINT64_MAX, UINT32_MAX);
+        pair<uint64_t, uint32_t> second(UINT64_MAX, UINT32_MAX);
+        bool first_idle = false;
+
+        for(uint32_t i = 0; i < num_streams; i++) {
+            RingBufferReportSink &sink = o->streams[i]->sink;
+
+            // read the watermark before the ring, so reports before it are visible
+            uint64_t watermark = sink.getWatermark();
+
+            Report r;
+            bool idle = !sink.peek(r);
+            if(idle && last)
+                continue;
+
+            pair<uint64_t, uint32_t> key(idle ? watermark : r.cycle, i);
+            if(key < first) {
+                second = first;
+                first = key;
+                first_idle = idle;
+            }else if(key < second) {
+                second = key;
+            }
+        }
+
+        if(first.second == UINT32_MAX || first_idle)
+            return drained;
+
+        // write reports of the first stream until another stream comes first
+        Stream *s = o->streams[first.second];
+        Report r;
+        while(s->sink.peek(r) && make_pair(r.cycle, first.second) < second) {
+            s->sink.pop(r);
+            append(o, s, r);
+            drained++;
+        }
+    }
+}
+
+/**
+ * Appends a report of stream s to the buffer of output o.
+ */
+void ReportWriter::append(Output *o, Stream *s, const Report &r) {
+
+    if(o->num_reports == 0 || r.cycle != o->last_cycle)
+        o->num_cycles++;
+    o->last_cycle = r.cycle;
+    o->num_reports++;
+
+    if(format == REPORT_FORMAT_BINARY)
+        appendBinary(o, s, r);
+    else
+        appendText(o, s, r);
+
+    if(o->buffer.size() >= buffer_size)
+        flush(o);
+}
+
+/**
+ * Appends a report in the text format of Automata::writeReportToFile(): "cycle : element id : report code".
+ */
+void ReportWriter::appendText(Output *o, Stream *s, const Report &r) {
+
+    // cycle in decimal, without going through a stream
+    char digits[20];
+    uint32_t n = 0;
+    uint64_t cycle = r.cycle;
+    do {
+        digits[n++] = '0' + cycle % 10;
+        cycle /= 10;
+    } while(cycle > 0);
+
+    while(n > 0)
+        o->buffer.push_back(digits[--n]);
+
+    o->buffer.append(" : ");
+    o->buffer.append(s->compiled->getReportId(r.element));
+    o->buffer.append(" : ");
+    o->buffer.append(s->compiled->getReportCode(r.element));
+    o->buffer.push_back('\n');
+}
+
+/**
+ * Appends a binary report record.
+ */
+void ReportWriter::appendBinary(Output *o, Stream *s, const Report &r) {
+
+    uint32_t element = s->base + r.element;
+
+    char record[BINARY_REPORT_RECORD_SIZE];
+    memcpy(record, &r.cycle, sizeof(uint64_t));
+    memcpy(record + sizeof(uint64_t), &element, sizeof(uint32_t));
+
+    o->buffer.append(record, BINARY_REPORT_RECORD_SIZE);
+}
+
+/**
+ * Appends the binary report header, element table and string pool of output o. Records start at the next 8 byte aligned offset.
+ */
+void ReportWriter::appendBinaryHeader(Output *o) {
+
+    vector<BinaryReportElement> table;
+    string pool;
+    for(Stream *s : o->streams) {
+        for(uint32_t id = 0; id < s->compiled->getNumElements(); id++) {
+            const string &report_id = s->compiled->getReportId(id);
+            const string &report_code = s->compiled->getReportCode(id);
+
+            BinaryReportElement e;
+            e.id_offset = pool.size();
+            e.id_length = report_id.size();
+            pool += report_id;
+
+            e.report_code_offset = pool.size();
+            e.report_code_length = report_code.size();
+            pool += report_code;
+
+            table.push_back(e);
+        }
+    }
+
+    BinaryReportHeader header;
+    memset(&header, 0, sizeof(BinaryReportHeader));
+    memcpy(header.magic, BINARY_REPORT_MAGIC, sizeof(header.magic));
+    header.version = BINARY_REPORT_VERSION;
+    header.byte_order = BINARY_REPORT_BYTE_ORDER;
+    header.num_elements = table.size();
+    header.strings_offset = sizeof(BinaryReportHeader) + table.size() * sizeof(BinaryReportElement);
+    header.strings_size = pool.size();
+    header.records_offset = (header.strings_offset + header.strings_size + 7) & ~7ULL;
+
+    o->buffer.append((const char *)&header, sizeof(BinaryReportHeader));
+    o->buffer.append((const char *)table.data(), table.size() * sizeof(BinaryReportElement));
+    o->buffer.append(pool);
+    o->buffer.resize(header.records_offset, '\0');
+}
+
+/**
+ * Writes and empties the buffer of output o.
+ */
+void ReportWriter::flush(Output *o) {
+
+    const char *data = o->buffer.data();
+    uint64_t remaining = o->buffer.size();
+
+    while(remaining > 0) {
+        ssize_t written = write(o->fd, data, remaining);
+        if(written < 0) {
+            if(errno == EINTR)
+                continue;
+            cout << "VAsim Error: could not write report file." << endl;
+            exit(-1);
+        }
+        data += written;
+        remaining -= written;
+    }
+
+    o->buffer.clear();
+}
@@ -0,0 +1,245 @@
+/**
+ * @file
+ */
+#include "simulationContext.h"
+
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * Constructs an empty context. resize() must be called before simulating a compiled automata.
+ */
+SimulationContext::SimulationContext() : SimulationContext(NULL) {
+
+}
+
+/**
+ * Constructs a context for the given compiled automata, which may be NULL.
+ */
+SimulationContext::SimulationContext(shared_ptr<const CompiledAutomata> compiled) {
+
+    maxActivations = 0;
+    cycle = 0;
+    progress_length = 0;
+    end_of_data = false;
+    startStatesTop = 0;
+    reportSink = &reports;
+
+    resize(compiled);
+}
+
+/**
+ *
+ */
+SimulationContext::~SimulationContext() {
+
+}
+
+/**
+ * Sizes the STE, gate input and special element state to a newly compiled graph. All STEs are disabled, all gate inputs are low and all special elements are reset. Reports collected so far are resolved against the previous graph first.
+ */
+void SimulationContext::resize(shared_ptr<const CompiledAutomata> c) {
+
+    if(compiled != NULL)
+        resolveReports();
+
+    compiled = c;
+
+    while(!enabledSTEs.empty())
+        enabledSTEs.pop_back();
+    startStatesTop = 0;
+
+    while(!activatedSTEs.empty())
+        activatedSTEs.pop_back();
+
+    raisedGateInputs.clear();
+    raisedGates.clear();
+    firedSpecialElements.clear();
+
+    if(compiled == NULL) {
+        steEnabled.clear();
+        specelStates.clear();
+        gateInputHigh.clear();
+        gateHighCount.clear();
+        gateAny.clear();
+        gateAll.clear();
+        return;
+    }
+
+    const GateNetwork *gates = compiled->getGateNetwork();
+
+    steEnabled.assign(compiled->getNumSTEs(), 0);
+    specelStates.assign(compiled->getNumSpecialElements(), SpecialElementState());
+    gateInputHigh.assign(gates->getNumInputs(), 0);
+    gateHighCount.assign(gates->getNumWords() * 64, 0);
+    gateAny.assign(gates->getNumWords(), 0);
+    gateAll.assign(gates->getNumWords(), 0);
+}
+
+/**
+ * Sends all further reports to sink instead of collecting them in the context. A NULL sink restores the default.
+ */
+void SimulationContext::setReportSink(ReportSink *sink) {
+
+    reportSink = (sink == NULL) ? &reports : sink;
+}
+
+/**
+ * Resolves the element ids and report codes of the reports collected since the last call through the compiled report table.
+ */
+void SimulationContext::resolveReports() {
+
+    vector<Report> &r = reports.getReports();
+
+    // start over if reports were removed since the last call
+    if(reportVector.size() > r.size()) {
+        reportVector.clear();
+        reportCodes.clear();
+    }
+
+    for(uint64_t i = reportVector.size(); i < r.size(); i++) {
+        reportVector.push_back(make_pair(r[i].cycle, compiled->getReportId(r[i].element)));
+        reportCodes.push_back(compiled->getReportCode(r[i].element));
+    }
+}
+
+/**
+ * Returns the collected reports as (cycle, element id) pairs. Only reports collected by the default sink are included. The pairs are built from the compiled report table on demand; the returned vector stays valid until the next call that changes the reports.
+ */
+vector<pair<uint64_t, string>> &SimulationContext::getReportVector() {
+
+    resolveReports();
+    return reportVector;
+}
+
+/**
+ * Returns the report codes of the collected reports, in the order of getReportVector().
+ */
+vector<string> &SimulationContext::getReportCodes() {
+
+    resolveReports();
+    return reportCodes;
+}
+
+/**
+ * Lowers all gate inputs raised this cycle. Only touches the raised inputs and their gates.
+ */
+void SimulationContext::clearGateInputs() {
+
+    for(uint32_t input : raisedGateInputs) {
+        gateInputHigh[input] = 0;
+    }
+    raisedGateInputs.clear();
+
+    for(uint32_t gate : raisedGates) {
+        gateHighCount[gate] = 0;
+        gateAny[gate >> 6] = 0;
+        gateAll[gate >> 6] = 0;
+    }
+    raisedGates.clear();
+}
+
+/**
+ * Resets every special element: counters return to zero and are neither dormant nor latched, and no input is raised or activated.
+ */
+void SimulationContext::clearSpecialElementStates() {
+
+    fill(specelStates.begin(), specelStates.end(), SpecialElementState());
+    firedSpecialElements.clear();
+}
+
+/**
+ * Disables all STEs, resets all special elements and clears all reports, statistics and the cycle counter so the context can simulate a new input stream.
+ */
+void SimulationContext::reset() {
+
+    clearEnabledSTEs();
+
+    while(!activatedSTEs.empty())
+        activatedSTEs.pop_back();
+
+    clearGateInputs();
+    clearSpecialElementStates();
+
+    // Reset all simulation stats
+    activationVector.clear();
+    activationHist.clear();
+    enabledHist.clear();
+    activatedHist.clear();
+    maxActivations = 0;
+    enabledCount.clear();
+    activatedCount.clear();
+
+    while(!enabledLastCycle.empty())
+        enabledLastCycle.pop();
+
+    while(!activatedLastCycle.empty())
+        activatedLastCycle.pop();
+
+    while(!reportedLastCycle.empty())
+        reportedLastCycle.pop();
+
+    // clear reports
+    reports.clear();
+    reportVector.clear();
+    reportCodes.clear();
+
+    // reset cycle counter to be 0
+    cycle = 0;
+    end_of_data = false;
+}
+
+/**
+ * Disables every enabled STE. Only touches the enabled stack, so the cost is proportional to the number of enabled STEs rather than the size of the automata.
+ */
+void SimulationContext::clearEnabledSTEs() {
+
+    while(!enabledSTEs.empty()) {
+        steEnabled[enabledSTEs.back()] = 0;
+        enabledSTEs.pop_back();
+    }
+
+    startStatesTop = 0;
+}
+
+/**
+ * Takes over the simulation state of other: the enabled STEs in the same stack order and the state of every special element. Both contexts must be sized for the same compiled automata. Reports, statistics and the cycle counter are left alone.
+ */
+void SimulationContext::copyState(const SimulationContext &other) {
+
+    clearEnabledSTEs();
+    for(uint32_t i = 0; i < other.enabledSTEs.size(); i++) {
+        uint32_t index = other.enabledSTEs.get(i);
+        steEnabled[index] = 1;
+        enabledSTEs.push_back(index);
+    }
+    startStatesTop = other.startStatesTop;
+
+    clearGateInputs();
+    specelStates = other.specelStates;
+    firedSpecialElements = other.firedSpecialElements;
+}
+
+/**
+ * Returns true if both contexts will simulate any further input identically: the same STEs are enabled in the same stack order, which decides the order of the reports within a cycle, and every special element holds the same value.
+ */
+bool SimulationContext::hasSameState(const SimulationContext &other) const {
+
+    if(enabledSTEs.size() != other.enabledSTEs.size() || startStatesTop != other.startStatesTop)
+        return false;
+
+    for(uint32_t i = 0; i < enabledSTEs.size(); i++) {
+        if(enabledSTEs.get(i) != other.enabledSTEs.get(i))
+            return false;
+    }
+
+    for(uint32_t i = 0; i < specelStates.size(); i++) {
+        const SpecialElementState &a = specelStates[i];
+        const SpecialElementState &b = other.specelStates[i];
+        if(a.value != b.value || a.dormant != b.dormant || a.latched != b.latched)
+            return false;
+    }
+
+    return true;
+}
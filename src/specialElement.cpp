@@ -10,6 +10,7 @@ using namespace std;
  */
 SpecialElement::SpecialElement(string id) : Element(id) {
 
+    compileInputs();
 }
 
 /*
@@ -28,14 +29,27 @@ bool SpecialElement::isSpecialElement() {
     return true;
 }
 
-/*
- *
+/**
+ * Counts the inputs of every port. Must be called again whenever inputs change; Automata::compileAutomata() does this for every special element.
+ */
+void SpecialElement::compileInputs() {
+
+    num_inputs = inputs.size();
+    for(uint32_t port = 0; port < 3; port++) {
+        port_inputs[port] = 0;
+    }
+
+    for(auto &in : inputs) {
+        port_inputs[Element::portFromString(in.first)]++;
+    }
+}
+
+/**
+ * Marks the element as enabled. Input signals are raised in the SpecialElementState of a simulation context, so the input named s ("fromElementId:toPort") is only kept for interface compatibility.
  */
 void SpecialElement::enable(string s) {
 
     enabled = true;
-    inputs[s] = true;
-
 }
 
 /*
@@ -43,11 +57,6 @@ void SpecialElement::enable(string s) {
  */
 void SpecialElement::disable() {
 
-    for(auto e : inputs) {
-
-        inputs[e.first] = false;
-    }
-    
     enabled = false;
 }
 
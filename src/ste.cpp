@@ -26,6 +26,17 @@ STE::STE(string id, string symbol_set, string strt) : Element(id),
 }
 
 
+/*
+ * Constructs an STE from an already parsed bit column. symbol_set must describe the same symbols and is kept as is.
+ */
+STE::STE(string id, string symbol_set, bitset<256> column, string strt) : Element(id),
+                                                                         symbol_set(symbol_set),
+                                                                         bit_column(column),
+                                                                         latched(false) {
+
+    setStart(strt);
+}
+
 STE::~STE() {
 
     // for some reason this is segfaulting within regex.h
@@ -651,6 +662,30 @@ bool STE::identicalProperties(STE *other) {
     return true;
 }
 
+/**
+ * Returns a hash of everything leftCompare() compares: the symbol set, the start type and the inputs. Left identical STEs have equal signatures.
+ */
+uint64_t STE::leftSignature() {
+
+    return hashCombine(hashCombine(std::hash<bitset<256>>()(bit_column), start), inputSignature());
+}
+
+/**
+ * Returns a hash of everything rightCompare() compares: the symbol set, the start type and the outputs. Right identical STEs have equal signatures.
+ */
+uint64_t STE::rightSignature() {
+
+    return hashCombine(hashCombine(std::hash<bitset<256>>()(bit_column), start), outputSignature());
+}
+
+/**
+ * Returns a hash of the start type, the inputs and the outputs. STEs on common paths, which only differ in their symbol sets, have equal signatures.
+ */
+uint64_t STE::pathSignature() {
+
+    return hashCombine(hashCombine(start, inputSignature()), outputSignature());
+}
+
 /**
  * Left compare compares this STE to the input STE and returns true
  *   if the two STEs are "left identical". This means that they are
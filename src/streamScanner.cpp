@@ -0,0 +1,169 @@
+/**
+ * @file
+ */
+#include "streamScanner.h"
+#include "automata.h"
+#include "workStealingScheduler.h"
+
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * Constructs a scanner over automata and enables report gathering on it. The automata must not change while the scanner is in use.
+ */
+StreamScanner::StreamScanner(Automata *a) :
+    automata(a),
+    interleave(STREAM_SCANNER_DEFAULT_INTERLEAVE) {
+
+    automata->setReport(true);
+    automata->getCompiledAutomata();
+}
+
+/**
+ *
+ */
+StreamScanner::~StreamScanner() {
+
+    for(SimulationContext *ctx : streams) {
+        delete ctx;
+    }
+}
+
+/**
+ * Opens a new input stream and returns its handle. Reports of the stream go to sink, or are collected in its context if sink is NULL. The context of a closed stream is reused if there is one.
+ */
+StreamHandle StreamScanner::open(ReportSink *sink) {
+
+    StreamHandle stream;
+    if(!closed.empty()) {
+        stream = closed.back();
+        closed.pop_back();
+        streams[stream]->reset();
+    }else{
+        stream = streams.size();
+        streams.push_back(automata->newSimulationContext());
+        opened.push_back(0);
+        started.push_back(0);
+    }
+
+    streams[stream]->setReportSink(sink);
+    opened[stream] = 1;
+    started[stream] = 0;
+
+    return stream;
+}
+
+/**
+ * Closes a stream. Its handle and context are reused by the next open(), so its reports must be read before.
+ */
+void StreamScanner::close(StreamHandle stream) {
+
+    if(!opened[stream])
+        return;
+
+    opened[stream] = 0;
+    closed.push_back(stream);
+}
+
+/**
+ * Restarts a stream at cycle 0 and clears its reports. Only the STEs enabled in the stream are touched.
+ */
+void StreamScanner::reset(StreamHandle stream) {
+
+    streams[stream]->reset();
+    started[stream] = 0;
+}
+
+/**
+ * Scans the next length symbols of a stream. If end is set, the last symbol is end of data.
+ */
+void StreamScanner::scan(StreamHandle stream, uint8_t *data, uint64_t length, bool end) {
+
+    start(stream);
+    automata->simulateChunk(*streams[stream], data, length, end);
+}
+
+/**
+ * Scans a batch of stream pieces on num_threads threads. Pieces of different streams run concurrently, up to getInterleave() streams in lockstep per thread; pieces of the same stream run one after another in batch order.
+ */
+void StreamScanner::scan(vector<StreamBlock> &blocks, uint32_t num_threads) {
+
+    // pieces of the same stream next to each other, in batch order
+    vector<uint32_t> order(blocks.size());
+    for(uint32_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return blocks[a].stream < blocks[b].stream;
+        });
+
+    // first piece of every stream in order
+    vector<uint32_t> runs;
+    for(uint32_t i = 0; i < order.size(); i++) {
+        if(i == 0 || blocks[order[i]].stream != blocks[order[i - 1]].stream)
+            runs.push_back(i);
+    }
+    uint32_t num_runs = runs.size();
+    runs.push_back(order.size());
+
+    // one task per group of interleaved streams
+    WorkStealingScheduler scheduler(num_threads);
+    for(uint32_t first = 0; first < num_runs; first += interleave) {
+        uint32_t last = min(first + interleave, num_runs);
+        scheduler.push([this, &blocks, &order, &runs, first, last](WorkStealingScheduler &, uint32_t) {
+                scanInterleaved(blocks, order, runs, first, last);
+            });
+    }
+
+    scheduler.run();
+}
+
+/**
+ * Scans the pieces of the streams runs[first] to runs[last - 1] in lockstep: the next piece of every stream in one interleaved pass, until no pieces are left.
+ */
+void StreamScanner::scanInterleaved(vector<StreamBlock> &blocks, vector<uint32_t> &order, vector<uint32_t> &runs, uint32_t first, uint32_t last) {
+
+    uint32_t k = last - first;
+    vector<uint32_t> next(runs.begin() + first, runs.begin() + last);
+    vector<SimulationContext *> ctxs(k);
+    vector<uint8_t *> data(k);
+    vector<uint64_t> lengths(k);
+    bool *ends = new bool[k];
+
+    while(true) {
+
+        uint32_t n = 0;
+        for(uint32_t j = 0; j < k; j++) {
+            if(next[j] == runs[first + j + 1])
+                continue;
+
+            const StreamBlock &block = blocks[order[next[j]++]];
+            start(block.stream);
+            ctxs[n] = streams[block.stream];
+            data[n] = block.data;
+            lengths[n] = block.length;
+            ends[n] = block.end;
+            n++;
+        }
+
+        if(n == 0)
+            break;
+
+        automata->simulateInterleaved(ctxs.data(), data.data(), lengths.data(), ends, n);
+    }
+
+    delete [] ends;
+}
+
+/**
+ * Enables the start states of a stream that has not started yet.
+ */
+void StreamScanner::start(StreamHandle stream) {
+
+    if(started[stream])
+        return;
+
+    automata->initializeSimulation(*streams[stream], true);
+    started[stream] = 1;
+}
@@ -792,7 +792,7 @@ void find_and_replace(std::string & source,
 /**
  * Checks the size of a file in bytes given a file name.
  */
-uint32_t fileSize(std::string fn) {
+uint64_t fileSize(std::string fn) {
 
     // open the file:
     std::ifstream file(fn, std::ios::binary);
@@ -832,23 +832,12 @@ std::vector<unsigned char> file2CharVector(std::string fn) {
     }
 
     // get its size:
-    std::streampos fileSize;
+    uint64_t size = fileSize(fn);
 
-    file.seekg(0, std::ios::end);
-    fileSize = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    // Stop eating new lines in binary mode!!!
-    file.unsetf(std::ios::skipws);
-
-    // reserve capacity
-    std::vector<unsigned char> vec;
-    vec.reserve(fileSize);
-
-    // read the data:
-    vec.insert(vec.begin(),
-               std::istream_iterator<unsigned char>(file),
-               std::istream_iterator<unsigned char>());
+    // read the data in one pass
+    std::vector<unsigned char> vec(size);
+    file.read((char *)vec.data(), size);
+    vec.resize(file.gcount());
 
     return vec;
 
@@ -876,17 +865,32 @@ uint8_t * parseInputStream(bool simulate, bool input_string, uint64_t *size, cha
             // From file
         } else {
             std::string input_fn = argv[optind];
-            std::vector<unsigned char> input2 = file2CharVector(input_fn);
-            *size = input2.size();
-            input = (uint8_t*)malloc(sizeof(uint8_t) * input2.size());
-            // copy bytes to unsigned ints
-            uint64_t counter = 0;
-            for(uint8_t val : input2){
-                input[counter] = (uint8_t)val;
-                counter++;
+
+            // open the file:
+            std::ifstream file(input_fn, std::ios::binary);
+            if(file.fail()){
+                inputFileCheck();
             }
+
+            // read directly into the simulation buffer
+            *size = fileSize(input_fn);
+            input = (uint8_t*)malloc(sizeof(uint8_t) * *size);
+            file.read((char *)input, *size);
+            *size = file.gcount();
         }
     }
 
     return input;
 }
+
+/**
+ * Mixes value into the hash seed. Used to build signatures of elements from their properties and edges.
+ */
+uint64_t hashCombine(uint64_t seed, uint64_t value) {
+
+    // splitmix64 finalizer
+    uint64_t h = seed + 0x9E3779B97F4A7C15ULL + value;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file
+ */
+#include "workStealingScheduler.h"
+
+#include <thread>
+
+using namespace std;
+
+/**
+ * Constructs a scheduler with num_workers worker threads, at least one.
+ */
+WorkStealingScheduler::WorkStealingScheduler(uint32_t num_workers) :
+    pending(0),
+    next_worker(0),
+    steals(0) {
+
+    if(num_workers < 1)
+        num_workers = 1;
+
+    for(uint32_t i = 0; i < num_workers; i++) {
+        workers.push_back(new Worker);
+    }
+}
+
+/**
+ *
+ */
+WorkStealingScheduler::~WorkStealingScheduler() {
+
+    for(Worker *w : workers) {
+        delete w;
+    }
+}
+
+/**
+ * Adds a task before run(). Tasks are dealt out to the workers round robin.
+ */
+void WorkStealingScheduler::push(SchedulerTask task) {
+
+    spawn(next_worker, task);
+    next_worker = (next_worker + 1) % workers.size();
+}
+
+/**
+ * Adds a task to the back of the deque of worker. Tasks call this with their own worker to spawn follow-up tasks, which then run next on the same worker unless they are stolen.
+ */
+void WorkStealingScheduler::spawn(uint32_t worker, SchedulerTask task) {
+
+    pending++;
+
+    Worker *w = workers[worker];
+    lock_guard<mutex> guard(w->lock);
+    w->tasks.push_back(task);
+}
+
+/**
+ * Runs all tasks, including the ones they spawn, and returns once all have finished. The calling thread works as worker 0.
+ */
+void WorkStealingScheduler::run() {
+
+    vector<thread> threads;
+    for(uint32_t i = 1; i < workers.size(); i++) {
+        threads.push_back(thread(&WorkStealingScheduler::work, this, i));
+    }
+
+    work(0);
+
+    for(thread &t : threads) {
+        t.join();
+    }
+}
+
+/**
+ * Takes the newest task of the worker's own deque.
+ */
+bool WorkStealingScheduler::pop(uint32_t worker, SchedulerTask &task) {
+
+    Worker *w = workers[worker];
+    lock_guard<mutex> guard(w->lock);
+
+    if(w->tasks.empty())
+        return false;
+
+    task = move(w->tasks.back());
+    w->tasks.pop_back();
+    return true;
+}
+
+/**
+ * Takes the oldest task of another worker, trying the workers after this one in turn.
+ */
+bool WorkStealingScheduler::steal(uint32_t worker, SchedulerTask &task) {
+
+    for(uint32_t i = 1; i < workers.size(); i++) {
+        Worker *victim = workers[(worker + i) % workers.size()];
+        lock_guard<mutex> guard(victim->lock);
+
+        if(!victim->tasks.empty()) {
+            task = move(victim->tasks.front());
+            victim->tasks.pop_front();
+            steals++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Worker loop. Runs own tasks first, then stolen ones, until no task is left anywhere. A task that is still running may spawn more, so workers only stop once nothing is pending.
+ */
+void WorkStealingScheduler::work(uint32_t worker) {
+
+    SchedulerTask task;
+
+    while(pending.load() > 0) {
+
+        if(pop(worker, task) || steal(worker, task)) {
+            task(*this, worker);
+            pending--;
+        }else{
+            this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,90 @@
+//
+// Report fixture shared by the engine and split simulation tests
+//
+
+#include "automata.h"
+
+/*
+ * Builds the automata shared by the engine and split simulation tests: an all-input pattern with a looping tail, a start-of-data pattern and an end-of-data reporting STE.
+ */
+void buildReportFixture(Automata &ap) {
+
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *loop = new STE("loop", "[bc]", "none");
+    STE *c = new STE("c", "[c]", "none");
+    STE *sod = new STE("sod", "[x]", "start-of-data");
+    STE *sod2 = new STE("sod2", "[a]", "none");
+    STE *eod = new STE("eod", "[y]", "all-input");
+    b->setReporting(true);
+    c->setReporting(true);
+    sod2->setReporting(true);
+    eod->setReporting(true);
+    eod->setEod(true);
+
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(loop);
+    ap.rawAddSTE(c);
+    ap.rawAddSTE(sod);
+    ap.rawAddSTE(sod2);
+    ap.rawAddSTE(eod);
+
+    ap.addEdge(a, b);
+    ap.addEdge(a, loop);
+    ap.addEdge(loop, loop);
+    ap.addEdge(loop, c);
+    ap.addEdge(sod, sod2);
+
+    ap.setQuiet(true);
+    ap.setReport(true);
+}
+
+// input of the report fixture; "y" only reports at the very end
+std::string reportFixtureInput = "xabcabc\nxab\ncabxacy\nxay";
+
+// (cycle, id) reports of the report fixture on its input
+std::vector<std::pair<uint64_t, std::string>> reportFixtureReports = {
+    {1, "sod2"}, {2, "b"}, {3, "c"}, {5, "b"}, {6, "c"},
+    {9, "sod2"}, {10, "b"}, {14, "b"}, {21, "sod2"}, {22, "eod"}
+};
+
+/*
+ * Builds an automata whose all-input start fans out to four reporting STEs, so several reports fall into one cycle. The ids are not in the order the STEs are added.
+ */
+void buildFanOutFixture(Automata &ap) {
+
+    STE *s = new STE("s", "[p]", "all-input");
+    ap.rawAddSTE(s);
+    for(std::string id : {"mm", "aa", "zz", "kk"}) {
+        STE *q = new STE(id, "[q]", "none");
+        q->setReporting(true);
+        ap.rawAddSTE(q);
+        ap.addEdge(s, q);
+    }
+
+    ap.setQuiet(true);
+    ap.setReport(true);
+}
+
+// input of the fan-out fixture
+std::string fanOutInput = "xxpq\npqpppq";
+
+/*
+ * Returns the reports of ap with the reports of each cycle in ascending compiled STE index order, the order of the bit-parallel and lazy DFA engines.
+ */
+std::vector<std::pair<uint64_t, std::string>> inCompiledOrder(Automata &ap, std::vector<std::pair<uint64_t, std::string>> reports) {
+
+    CompiledAutomata *compiled = ap.getCompiledAutomata();
+    auto index = [&](const std::pair<uint64_t, std::string> &r) {
+        uint32_t i = 0;
+        compiled->getIndex(ap.getElement(r.second), &i);
+        return std::make_pair(r.first, i);
+    };
+
+    std::stable_sort(reports.begin(), reports.end(),
+                     [&](const std::pair<uint64_t, std::string> &a, const std::pair<uint64_t, std::string> &b) {
+                         return index(a) < index(b);
+                     });
+    return reports;
+}
@@ -0,0 +1,113 @@
+#include "automata.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace std;
+
+string testname = "TEST_BINARY_AUTOMATA";
+
+/**
+ * TEST DESCRIPTION: an automata written with automataToBinaryFile() and loaded back should have the same elements and produce the same reports as the original, including counter modes and ports. Corrupt files should be rejected.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    STE *count = new STE("count", "[c]", "all-input");
+    STE *reset = new STE("reset", "[r]", "all-input");
+    STE *first = new STE("first", "[a-b]", "start-of-data");
+    STE *report = new STE("report", "*", "none");
+    report->setReporting(true);
+    report->setReportCode("42");
+    first->setReporting(true);
+
+    ap.rawAddSTE(count);
+    ap.rawAddSTE(reset);
+    ap.rawAddSTE(first);
+    ap.rawAddSTE(report);
+
+    Counter *counter = new Counter("counter", 2, "roll");
+    ap.rawAddSpecialElement(counter);
+
+    ap.addEdge(count->getId(), counter->getId() + ":cnt");
+    ap.addEdge(reset->getId(), counter->getId() + ":rst");
+    ap.addEdge(counter->getId(), report->getId());
+    ap.addEdge(first->getId(), count->getId());
+
+    string fn = "testBinaryAutomata.vab";
+    ap.automataToBinaryFile(fn);
+
+    Automata loaded(fn);
+    assert(loaded.getErrorCode() == E_SUCCESS, testname, "1");
+    assert(loaded.getElements().size() == 5, testname, "2");
+    assert(loaded.getStarts().size() == 3, testname, "3");
+    assert(loaded.getReports().size() == 2, testname, "4");
+
+    Counter *loaded_counter = static_cast<Counter*>(loaded.getElement("counter"));
+    assert(loaded_counter->getType() == COUNTER_T, testname, "5");
+    assert(loaded_counter->getTarget() == 2, testname, "6");
+    assert(loaded_counter->getMode().compare("roll") == 0, testname, "7");
+    assert(loaded.getElement("report")->getReportCode().compare("42") == 0, testname, "8");
+    assert(static_cast<STE*>(loaded.getElement("first"))->getBitColumn() == first->getBitColumn(), testname, "9");
+
+    // both automata report identically
+    string input = "accccrcccbccc\naccc";
+
+    ap.setQuiet(true);
+    ap.setReport(true);
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+
+    loaded.setQuiet(true);
+    loaded.setReport(true);
+    loaded.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+
+    assert(ap.getReportVector().size() > 0, testname, "10");
+    assert(ap.getReportVector() == loaded.getReportVector(), testname, "11");
+
+    // truncated files are rejected
+    FILE *f = fopen(fn.c_str(), "r+");
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    truncate(fn.c_str(), size - 1);
+
+    Automata truncated(fn);
+    assert(truncated.getErrorCode() == E_MALFORMED_AUTOMATA, testname, "12");
+
+    // section offsets that wrap around are rejected
+    ap.automataToBinaryFile(fn);
+    BinaryAutomataHeader header;
+    f = fopen(fn.c_str(), "r+");
+    fread(&header, sizeof(header), 1, f);
+    header.elements_offset = UINT64_MAX - 8;
+    fseek(f, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, f);
+    fclose(f);
+
+    Automata wrapped(fn);
+    assert(wrapped.getErrorCode() == E_MALFORMED_AUTOMATA, testname, "13");
+
+    // duplicate ids are rejected without adding any element
+    ap.automataToBinaryFile(fn);
+    BinaryElement records[2];
+    f = fopen(fn.c_str(), "r+");
+    fread(&header, sizeof(header), 1, f);
+    fseek(f, header.elements_offset, SEEK_SET);
+    fread(records, sizeof(BinaryElement), 2, f);
+    records[1].id = records[0].id;
+    fseek(f, header.elements_offset, SEEK_SET);
+    fwrite(records, sizeof(BinaryElement), 2, f);
+    fclose(f);
+
+    Automata duplicate(fn);
+    assert(duplicate.getErrorCode() == E_MALFORMED_AUTOMATA, testname, "14");
+    assert(duplicate.getElements().size() == 0, testname, "15");
+    assert(duplicate.getStarts().size() == 0, testname, "16");
+
+    remove(fn.c_str());
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
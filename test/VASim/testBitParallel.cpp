@@ -0,0 +1,48 @@
+#include "automata.h"
+#include "test.h"
+#include "reportFixture.h"
+
+using namespace std;
+
+string testname = "TEST_BIT_PARALLEL";
+
+/**
+ * TEST DESCRIPTION: the bit-parallel engine should produce the same reports in the same cycles as the default engine, with the reports of one cycle in compiled STE index order, and none when reporting is disabled.
+ */
+int main(int argc, char * argv[]) {
+
+    uint8_t *input = (uint8_t*)reportFixtureInput.c_str();
+    uint64_t size = reportFixtureInput.size();
+
+    Automata bitpar;
+    buildReportFixture(bitpar);
+    bitpar.simulateBitParallel(input, 0, size, size);
+
+    assert(bitpar.getReportVector() == reportFixtureReports, testname, "report mismatch");
+
+    // reports of one cycle are sent in compiled STE index order
+    Automata nfa;
+    Automata fan;
+    buildFanOutFixture(nfa);
+    buildFanOutFixture(fan);
+
+    uint8_t *fanInput = (uint8_t*)fanOutInput.c_str();
+    uint64_t fanSize = fanOutInput.size();
+    nfa.simulate(fanInput, 0, fanSize, fanSize);
+    fan.simulateBitParallel(fanInput, 0, fanSize, fanSize);
+
+    vector<pair<uint64_t, string>> expected = inCompiledOrder(nfa, nfa.getReportVector());
+    assert(expected != nfa.getReportVector(), testname, "fan-out fixture already in index order");
+    assert(fan.getReportVector() == expected, testname, "same-cycle report order");
+
+    // without reporting, the engine must not collect reports
+    Automata silent;
+    buildReportFixture(silent);
+    silent.setReport(false);
+    silent.simulateBitParallel(input, 0, size, size);
+
+    assert(silent.getReportVector().size() == 0, testname, "reports collected without reporting");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
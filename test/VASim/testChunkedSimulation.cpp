@@ -0,0 +1,40 @@
+#include "automata.h"
+#include "test.h"
+#include "reportFixture.h"
+
+using namespace std;
+
+string testname = "TEST_CHUNKED_SIMULATION";
+
+/**
+ * TEST DESCRIPTION: simulating an input in chunks of any size should produce exactly the same reports, in the same order, as simulating it in one piece.
+ */
+int main(int argc, char * argv[]) {
+
+    uint8_t *input = (uint8_t*)reportFixtureInput.c_str();
+    uint64_t size = reportFixtureInput.size();
+
+    Automata whole;
+    buildReportFixture(whole);
+    whole.simulate(input, 0, size, size);
+
+    assert(whole.getReportVector() == reportFixtureReports, testname, "report mismatch");
+
+    for(uint64_t chunk = 1; chunk <= size; chunk++) {
+
+        Automata chunked;
+        buildReportFixture(chunked);
+        chunked.initializeSimulation();
+
+        for(uint64_t start = 0; start < size; start += chunk) {
+            uint64_t length = min(chunk, size - start);
+            chunked.simulateChunk(input + start, length, start + length == size);
+        }
+
+        assert(chunked.getCycle() == size, testname, "cycle mismatch");
+        assert(chunked.getReportVector() == reportFixtureReports, testname, "chunked report mismatch");
+    }
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
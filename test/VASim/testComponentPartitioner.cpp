@@ -0,0 +1,103 @@
+#include "automata.h"
+#include "componentPartitioner.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_COMPONENT_PARTITIONER";
+
+/**
+ * TEST DESCRIPTION: components that match more input, or that were measured to be more active, should cost more, and longest-processing-time partitioning should balance the costs among threads.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    // a hot component: a start state that matches every symbol, with fan-out 4
+    STE *hot = new STE("hot", "*", "all-input");
+    ap.rawAddSTE(hot);
+    for(uint32_t i = 0; i < 4; i++) {
+        STE *child = new STE("hot" + to_string(i), "[a-z]", "none");
+        ap.rawAddSTE(child);
+        ap.addEdge(hot, child);
+    }
+
+    // eight cold components matching a single symbol each
+    for(uint32_t i = 0; i < 8; i++) {
+        STE *start = new STE("cold" + to_string(i), "[x]", "all-input");
+        STE *next = new STE("cold" + to_string(i) + "_next", "[y]", "none");
+        next->setReporting(true);
+        ap.rawAddSTE(start);
+        ap.rawAddSTE(next);
+        ap.addEdge(start, next);
+    }
+
+    ap.setQuiet(true);
+    vector<Automata *> ccs = ap.splitConnectedComponents();
+    assert(ccs.size() == 9, testname, "1");
+
+    // find the hot component
+    uint32_t h = 0;
+    for(uint32_t i = 0; i < ccs.size(); i++) {
+        if(ccs[i]->getElements().count("hot"))
+            h = i;
+    }
+
+    ComponentPartitioner partitioner(ccs);
+
+    // the hot component costs more than all cold components together
+    double cold = 0;
+    for(uint32_t i = 0; i < ccs.size(); i++) {
+        if(i != h) {
+            assert(partitioner.getCost(i) < partitioner.getCost(h), testname, "2");
+            cold += partitioner.getCost(i);
+        }
+    }
+    assert(cold < partitioner.getCost(h), testname, "3");
+
+    // the hot component gets a thread of its own
+    vector<uint32_t> assignment = partitioner.partition(2);
+    for(uint32_t i = 0; i < ccs.size(); i++) {
+        if(i != h)
+            assert(assignment[i] != assignment[h], testname, "4");
+    }
+
+    // the cold components are spread evenly
+    assignment = partitioner.partition(9);
+    vector<uint32_t> per_thread(9, 0);
+    for(uint32_t tid : assignment)
+        per_thread[tid]++;
+    for(uint32_t n : per_thread)
+        assert(n == 1, testname, "5");
+
+    // the hot component bounds the run, so more threads do not pay off
+    assert(partitioner.chooseNumThreads(16) == 1, testname, "6");
+
+    // equally expensive components each get a thread, up to the limit
+    vector<Automata *> cold_ccs;
+    for(uint32_t i = 0; i < ccs.size(); i++) {
+        if(i != h)
+            cold_ccs.push_back(ccs[i]);
+    }
+    ComponentPartitioner cold_partitioner(cold_ccs);
+    assert(cold_partitioner.chooseNumThreads(16) == 8, testname, "7");
+    assert(cold_partitioner.chooseNumThreads(4) == 4, testname, "8");
+
+    // measured activity overrides the structure: make a cold component the hot one
+    unordered_map<Element*, uint32_t> enabledCount;
+    unordered_map<Element*, uint32_t> activatedCount;
+    uint32_t c = (h == 0) ? 1 : 0;
+    for(auto e : ccs[c]->getElements()) {
+        enabledCount[e.second] = 1000;
+        activatedCount[e.second] = 1000;
+    }
+
+    ComponentPartitioner profiled(ccs, enabledCount, activatedCount, 1000);
+    for(uint32_t i = 0; i < ccs.size(); i++) {
+        if(i != c)
+            assert(profiled.getCost(i) < profiled.getCost(c), testname, "9");
+    }
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
@@ -0,0 +1,73 @@
+#include "automata.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_CONNECTED_COMPONENTS";
+
+/**
+ * TEST DESCRIPTION: components should be split along edges in either direction, ordered by their first start state, keep their special elements, and drop elements not connected to any start state.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    // {x, y}, {a, b, c, d, or}, {z} and the unconnected {u, v}
+    STE *x = new STE("x", "[x]", "start-of-data");
+    STE *y = new STE("y", "[y]", "none");
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *c = new STE("c", "[c]", "all-input");
+    STE *d = new STE("d", "[d]", "none");
+    STE *z = new STE("z", "[z]", "all-input");
+    STE *u = new STE("u", "[u]", "none");
+    STE *v = new STE("v", "[v]", "none");
+    OR *orgate = new OR("or");
+
+    ap.rawAddSTE(x);
+    ap.rawAddSTE(y);
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(c);
+    ap.rawAddSTE(d);
+    ap.rawAddSTE(z);
+    ap.rawAddSTE(u);
+    ap.rawAddSTE(v);
+    ap.rawAddSpecialElement(orgate);
+
+    y->setReporting(true);
+    orgate->setReporting(true);
+
+    // a and c only meet in d and in the or gate
+    ap.addEdge(x, y);
+    ap.addEdge(a, b);
+    ap.addEdge(c, d);
+    ap.addEdge(b, d);
+    ap.addEdge("b", "or");
+    ap.addEdge("d", "or");
+    ap.addEdge(u, v);
+
+    ap.setQuiet(true);
+    vector<Automata *> ccs = ap.splitConnectedComponents();
+
+    assert(ccs.size() == 3, testname, "1");
+
+    // components follow the order of the start states
+    assert(ccs[0]->getElements().size() == 2, testname, "2");
+    assert(ccs[0]->getElement("x") == x && ccs[0]->getElement("y") == y, testname, "3");
+    assert(ccs[1]->getElements().size() == 5, testname, "4");
+    assert(ccs[1]->getSpecialElements().size() == 1, testname, "5");
+    assert(ccs[1]->getStarts().size() == 2, testname, "6");
+    assert(ccs[1]->getReports().size() == 1, testname, "7");
+    assert(ccs[2]->getElements().size() == 1, testname, "8");
+    assert(ccs[2]->getElement("z") == z, testname, "9");
+
+    // every component is a complete automata on its own
+    for(Automata *cc : ccs) {
+        cc->validate();
+        assert(cc->getErrorCode() == E_SUCCESS, testname, "10");
+    }
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
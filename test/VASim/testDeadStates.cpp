@@ -0,0 +1,117 @@
+#include "automata.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_DEAD_STATES";
+
+/**
+ * TEST DESCRIPTION: dead state elimination should remove elements that cannot reach a report and elements that cannot be reached from a start state, keep everything else with its edges, keep inverters whose inputs are all unreachable, and leave the reports of a simulation unchanged.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    // live path: a -> b -> c (reporting), with a dead branch b -> d -> e
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *c = new STE("c", "[c]", "none");
+    STE *d = new STE("d", "[d]", "none");
+    STE *e = new STE("e", "[e]", "none");
+    c->setReporting(true);
+
+    // unreachable path: u -> v (reporting), with no start state
+    STE *u = new STE("u", "[u]", "none");
+    STE *v = new STE("v", "[v]", "none");
+    v->setReporting(true);
+
+    // a start state that cannot report
+    STE *s = new STE("s", "[s]", "start-of-data");
+
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(c);
+    ap.rawAddSTE(d);
+    ap.rawAddSTE(e);
+    ap.rawAddSTE(u);
+    ap.rawAddSTE(v);
+    ap.rawAddSTE(s);
+    ap.addEdge(a, b);
+    ap.addEdge(b, c);
+    ap.addEdge(b, d);
+    ap.addEdge(d, e);
+    ap.addEdge(u, v);
+    ap.addEdge(u, c);
+    ap.addEdge(s, b);
+
+    ap.setQuiet(true);
+    ap.setReport(true);
+
+    string input = "abcabdeuvsbc";
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    vector<pair<uint64_t, string>> expected = ap.getReportVector();
+
+    uint32_t removed = ap.eliminateDeadStates();
+    assert(removed == 4, testname, "1");
+    assert(ap.getElements().size() == 4, testname, "2");
+
+    // s can reach a report through b, so it stays
+    assert(ap.getElements().count("a") && ap.getElements().count("b") &&
+           ap.getElements().count("c") && ap.getElements().count("s"), testname, "3");
+
+    // edges to removed elements are gone, edges among kept ones are not
+    assert(b->getOutputs().size() == 1, testname, "4");
+    assert(c->getInputs().size() == 1, testname, "5");
+    assert(ap.getReports().size() == 1, testname, "6");
+    assert(ap.getStarts().size() == 2, testname, "7");
+
+    // nothing left to remove
+    assert(ap.eliminateDeadStates() == 0, testname, "8");
+
+    ap.reset();
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    assert(ap.getReportVector() == expected, testname, "9");
+
+    // an inverter fires every cycle its unreachable input u is low
+    Automata ip;
+
+    STE *ia = new STE("a", "[a]", "all-input");
+    STE *it = new STE("t", "[b]", "none");
+    STE *iu = new STE("u", "[u]", "none");
+    STE *iw = new STE("w", "[w]", "none");
+    STE *ir = new STE("r", "[x]", "none");
+    Inverter *inv = new Inverter("inv");
+    it->setReporting(true);
+    ir->setReporting(true);
+
+    ip.rawAddSTE(ia);
+    ip.rawAddSTE(it);
+    ip.rawAddSTE(iu);
+    ip.rawAddSTE(iw);
+    ip.rawAddSTE(ir);
+    ip.rawAddSpecialElement(inv);
+    ip.addEdge(ia, it);
+    ip.addEdge(iw, iu);
+    ip.addEdge(iu, inv);
+    ip.addEdge(inv, ir);
+
+    ip.setQuiet(true);
+    ip.setReport(true);
+
+    input = "xxabxx";
+    ip.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    expected = ip.getReportVector();
+    assert(expected.size() == 4, testname, "10");
+
+    // the input of the inverter stays, only w goes
+    assert(ip.eliminateDeadStates() == 1, testname, "11");
+    assert(ip.getElements().count("inv") && ip.getElements().count("r") &&
+           ip.getElements().count("u") && !ip.getElements().count("w"), testname, "12");
+
+    ip.reset();
+    ip.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    assert(ip.getReportVector() == expected, testname, "13");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
@@ -0,0 +1,80 @@
+#include "automata.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_ELEMENT_GRAPH";
+
+/**
+ * TEST DESCRIPTION: the integer graph should number every element densely and mirror its edges as successors and predecessors, keeping counter ports. The int ids of the elements should be left alone.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *r = new STE("r", "[r]", "all-input");
+    STE *out = new STE("out", "*", "none");
+    out->setReporting(true);
+
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(r);
+    ap.rawAddSTE(out);
+
+    Counter *counter = new Counter("counter", 2, "pulse");
+    ap.rawAddSpecialElement(counter);
+
+    ap.addEdge("a", "b");
+    ap.addEdge("b", "b");
+    ap.addEdge("b", "counter:cnt");
+    ap.addEdge("r", "counter:rst");
+    ap.addEdge("counter", "out");
+
+    for(auto &e : ap.getElements())
+        e.second->setIntId(100);
+
+    ElementGraph graph(ap.getElements());
+
+    assert(graph.size() == 5, testname, "1");
+    assert(graph.getNumEdges() == 5, testname, "2");
+
+    // ids are dense and kept in the graph
+    for(uint32_t i = 0; i < graph.size(); i++) {
+        assert(graph.getId(graph.getElement(i)) == i, testname, "3");
+        assert(graph.getElement(i)->getIntId() == 100, testname, "3");
+    }
+
+    // b has a self loop and a counter child on its cnt port
+    uint32_t id_b = graph.getId(b);
+    bool self = false;
+    bool cnt = false;
+    for(const GraphEdge *e = graph.succBegin(id_b); e != graph.succEnd(id_b); e++) {
+        if(e->node == id_b && e->port == PORT_NONE)
+            self = true;
+        if(e->node == graph.getId(counter) && e->port == PORT_CNT)
+            cnt = true;
+    }
+    assert(self && cnt, testname, "4");
+
+    // counter has one parent per port
+    uint32_t id_counter = graph.getId(counter);
+    assert(graph.predEnd(id_counter) - graph.predBegin(id_counter) == 2, testname, "5");
+    for(const GraphEdge *e = graph.predBegin(id_counter); e != graph.predEnd(id_counter); e++) {
+        if(e->node == id_b)
+            assert(e->port == PORT_CNT, testname, "6");
+        else
+            assert(e->node == graph.getId(r) && e->port == PORT_RST, testname, "7");
+    }
+
+    // a has no parents
+    uint32_t id_a = graph.getId(a);
+    assert(graph.predBegin(id_a) == graph.predEnd(id_a), testname, "8");
+
+    assert(Element::portFromString("counter:rst") == PORT_RST, testname, "9");
+    assert(Element::portToString(PORT_CNT).compare(":cnt") == 0, testname, "10");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
@@ -0,0 +1,127 @@
+#include "automata.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_GATE_NETWORK";
+
+/**
+ * TEST DESCRIPTION: gates should be levelized above their special element parents and calculated a word at a time with the same results as their calculate() functions, including gates driven by gates and counters. STE children should still be enabled in compiled order.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "all-input");
+
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+
+    // level 0: nor(a, b), and(a, b), counter(a); level 1: or(nor, counter); level 2: inv(or)
+    NOR *norgate = new NOR("nor");
+    AND *andgate = new AND("and");
+    Counter *counter = new Counter("counter", 2, "pulse");
+    OR *orgate = new OR("or");
+    Inverter *inverter = new Inverter("inv");
+    NOR *lonely = new NOR("lonely");
+
+    ap.rawAddSpecialElement(norgate);
+    ap.rawAddSpecialElement(andgate);
+    ap.rawAddSpecialElement(counter);
+    ap.rawAddSpecialElement(orgate);
+    ap.rawAddSpecialElement(inverter);
+    ap.rawAddSpecialElement(lonely);
+
+    andgate->setReporting(true);
+    orgate->setReporting(true);
+    inverter->setReporting(true);
+
+    ap.addEdge("a", "nor");
+    ap.addEdge("b", "nor");
+    ap.addEdge("a", "and");
+    ap.addEdge("b", "and");
+    ap.addEdge("a", "counter:cnt");
+    ap.addEdge("nor", "or");
+    ap.addEdge("counter", "or");
+    ap.addEdge("or", "inv");
+
+    ap.setReport(true);
+
+    const GateNetwork *gates = ap.compileAutomata()->getGateNetwork();
+    ap.initializeSimulation();
+
+    assert(gates->getNumGates() == 5, testname, "1");
+    assert(gates->getNumLevels() == 3, testname, "2");
+
+    // each level starts on its own word
+    assert(gates->getNumWords() == 3, testname, "3");
+
+    // the counter is evaluated on its own at level 0
+    assert(gates->getLevelOthersEnd(0) - gates->getLevelOthersBegin(0) == 1, testname, "4");
+
+    // "x": nor is high, so or is high and inv is low
+    ap.simulate('x');
+    vector<pair<uint64_t, string>> reports = ap.getReportVector();
+    assert(reports.size() == 1 && reports[0].second.compare("or") == 0, testname, "5");
+
+    // "a": nor is low and the counter has not reached its target, so inv reports
+    ap.simulate('a');
+    reports = ap.getReportVector();
+    assert(reports.size() == 2 && reports[1].second.compare("inv") == 0, testname, "6");
+
+    // "a": the counter pulses, so or reports
+    ap.simulate('a');
+    reports = ap.getReportVector();
+    assert(reports.size() == 3 && reports[2].second.compare("or") == 0, testname, "7");
+
+    // "b": only one input of and is high, nor is low
+    ap.simulate('b');
+    reports = ap.getReportVector();
+    assert(reports.size() == 4 && reports[3].second.compare("inv") == 0, testname, "8");
+
+    // gate inputs do not leak into the next cycle
+    ap.simulate('x');
+    reports = ap.getReportVector();
+    assert(reports.size() == 5 && reports[4].second.compare("or") == 0, testname, "9");
+
+    // special elements enable their STE children in compiled order, even
+    // when a counter is compiled before gates of its level
+    Automata order;
+    STE *s = new STE("s", "[s]", "all-input");
+    order.rawAddSTE(s);
+
+    AND *andgate2 = new AND("and");
+    OR *orgate2 = new OR("or");
+    Counter *counter2 = new Counter("counter", 1, "pulse");
+    order.rawAddSpecialElement(andgate2);
+    order.rawAddSpecialElement(orgate2);
+    order.rawAddSpecialElement(counter2);
+    order.addEdge("s", "and");
+    order.addEdge("s", "or");
+    order.addEdge("s", "counter:cnt");
+
+    unordered_map<string, string> child = {{"and", "tand"}, {"or", "tor"}, {"counter", "tcounter"}};
+    for(auto c : child) {
+        STE *t = new STE(c.second, "[z]", "none");
+        t->setReporting(true);
+        order.rawAddSTE(t);
+        order.addEdge(c.first, c.second);
+    }
+
+    order.setReport(true);
+    CompiledAutomata *compiled = order.compileAutomata();
+    order.initializeSimulation();
+    order.simulate('s');
+    order.simulate('z');
+
+    // the enabled stack is popped from the top
+    vector<pair<uint64_t, string>> expected;
+    for(uint32_t i = compiled->getNumSpecialElements(); i > 0; i--)
+        expected.push_back(make_pair(1, child[compiled->getSpecialElement(i - 1)->getId()]));
+
+    assert(order.getReportVector() == expected, testname, "10");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
@@ -0,0 +1,69 @@
+#include "automata.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_GENERATE_DFA";
+
+/**
+ * TEST DESCRIPTION: the DFA should report in exactly the cycles the NFA reports in, have one STE per distinct (NFA state set, symbol set) pair, and give up cleanly when it exceeds its state budget.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    // "abc" and "a[bx]d" share their first two symbols
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *c = new STE("c", "[c]", "none");
+    STE *bx = new STE("bx", "[bx]", "none");
+    STE *d = new STE("d", "[d]", "none");
+    c->setReporting(true);
+    d->setReporting(true);
+
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(c);
+    ap.rawAddSTE(bx);
+    ap.rawAddSTE(d);
+    ap.addEdge(a, b);
+    ap.addEdge(b, c);
+    ap.addEdge(a, bx);
+    ap.addEdge(bx, d);
+
+    ap.setQuiet(true);
+    ap.setReport(true);
+
+    string input = "abcabdaxdabcaaxdzabd";
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+
+    set<uint64_t> expected;
+    for(auto r : ap.getReportVector())
+        expected.insert(r.first);
+    assert(expected.size() == 6, testname, "1");
+
+    Automata *dfa = ap.generateDFA();
+    assert(dfa != NULL, testname, "2");
+
+    // {a}, {b, bx}, {bx}, {c}, {d} and the empty set, which is entered
+    //  on four different symbol sets
+    assert(dfa->getElements().size() == 9, testname, "3");
+    assert(dfa->getReports().size() == 2, testname, "4");
+
+    dfa->setQuiet(true);
+    dfa->setReport(true);
+    dfa->simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+
+    set<uint64_t> cycles;
+    for(auto r : dfa->getReportVector())
+        cycles.insert(r.first);
+    assert(cycles == expected, testname, "5");
+    assert(dfa->getReportVector().size() == expected.size(), testname, "6");
+
+    // a DFA over its state budget is not built
+    assert(ap.generateDFA(8) == NULL, testname, "7");
+    assert(ap.generateDFA(9) != NULL, testname, "8");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
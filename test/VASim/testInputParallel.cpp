@@ -0,0 +1,135 @@
+#include "automata.h"
+#include "test.h"
+#include "reportFixture.h"
+
+using namespace std;
+
+string testname = "TEST_INPUT_PARALLEL";
+
+/*
+ * Splits input into num_slices slices, simulates each slice speculatively in its own context, reconciles them in order and returns the reports of all slices in input order.
+ */
+vector<pair<uint64_t, string>> simulateSlices(Automata &ap, string &input, uint64_t num_slices) {
+
+    uint8_t *inputs = (uint8_t*)input.c_str();
+    uint64_t size = input.size();
+    uint64_t slice_size = size / num_slices;
+    vector<SimulationContext *> slices;
+
+    // speculative pass
+    for(uint64_t slice = 0; slice < num_slices; slice++) {
+        uint64_t length = slice_size;
+        if(slice == num_slices - 1)
+            length += size % num_slices;
+
+        slices.push_back(ap.newSimulationContext());
+        ap.simulate(*slices[slice], inputs, slice * slice_size, length, size);
+    }
+
+    // reconciliation pass
+    for(uint64_t slice = 1; slice < num_slices; slice++) {
+        uint64_t length = slice_size;
+        if(slice == num_slices - 1)
+            length += size % num_slices;
+
+        ap.reconcileSlice(*slices[slice], *slices[slice - 1], inputs, slice * slice_size, length, size);
+    }
+
+    vector<pair<uint64_t, string>> reports;
+    for(SimulationContext *ctx : slices) {
+        reports.insert(reports.end(), ctx->getReportVector().begin(), ctx->getReportVector().end());
+        delete ctx;
+    }
+
+    return reports;
+}
+
+/*
+ * Checks that every split of input into slices reports exactly what ap reports on the whole input.
+ */
+void checkSlices(Automata &ap, string input, string message) {
+
+    uint8_t *inputs = (uint8_t*)input.c_str();
+    uint64_t size = input.size();
+
+    ap.reset();
+    ap.simulate(inputs, 0, size, size);
+    vector<pair<uint64_t, string>> expected = ap.getReportVector();
+
+    for(uint64_t num_slices = 2; num_slices <= size; num_slices++) {
+        assert(simulateSlices(ap, input, num_slices) == expected, testname, message);
+    }
+}
+
+/**
+ * TEST DESCRIPTION: splitting the input into any number of slices, simulating each slice independently and reconciling them in order should produce exactly the same reports, in the same order, as simulating the input in one piece, with or without counters and with several reports in one cycle.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+    buildReportFixture(ap);
+
+    uint8_t *inputs = (uint8_t*)reportFixtureInput.c_str();
+    uint64_t size = reportFixtureInput.size();
+    ap.simulate(inputs, 0, size, size);
+    assert(ap.getReportVector() == reportFixtureReports, testname, "report mismatch");
+
+    checkSlices(ap, reportFixtureInput, "slice report mismatch");
+
+    // several STEs report in the same cycle, in stack order rather than id order
+    Automata fan;
+
+    STE *s = new STE("s", "[p]", "all-input");
+    fan.rawAddSTE(s);
+    for(string id : {"mm", "aa", "zz", "kk"}) {
+        STE *q = new STE(id, "[q]", "none");
+        q->setReporting(true);
+        fan.rawAddSTE(q);
+        fan.addEdge(s, q);
+    }
+
+    fan.setQuiet(true);
+    fan.setReport(true);
+
+    string fanInput = "xxpq\npqpppq";
+    inputs = (uint8_t*)fanInput.c_str();
+    size = fanInput.size();
+    fan.simulate(inputs, 0, size, size);
+    vector<pair<uint64_t, string>> fanReports = fan.getReportVector();
+    assert(fanReports.size() == 12, testname, "fan-out reports");
+    assert(fanReports[0].first == fanReports[3].first, testname, "fan-out cycle");
+
+    checkSlices(fan, fanInput, "fan-out report mismatch");
+
+    // counters are not monotone
+    Automata cp;
+
+    STE *x = new STE("x", "[a]", "all-input");
+    STE *r = new STE("r", "[\\n]", "all-input");
+    STE *y = new STE("y", "[b]", "none");
+    Counter *counter = new Counter("counter", 2, "roll");
+    counter->setReporting(true);
+    y->setReporting(true);
+
+    cp.rawAddSTE(x);
+    cp.rawAddSTE(r);
+    cp.rawAddSTE(y);
+    cp.rawAddSpecialElement(counter);
+    cp.addEdge("x", "counter:cnt");
+    cp.addEdge("r", "counter:rst");
+    cp.addEdge("counter", "y");
+
+    cp.setQuiet(true);
+    cp.setReport(true);
+
+    string counterInput = "aabaab\naab\nab";
+    inputs = (uint8_t*)counterInput.c_str();
+    size = counterInput.size();
+    cp.simulate(inputs, 0, size, size);
+    assert(cp.getReportVector().size() == 6, testname, "counter reports");
+
+    checkSlices(cp, counterInput, "counter report mismatch");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
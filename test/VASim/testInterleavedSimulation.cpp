@@ -0,0 +1,97 @@
+#include "automata.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_INTERLEAVED_SIMULATION";
+
+/**
+ * TEST DESCRIPTION: streams of different lengths simulated in lockstep should report exactly like each stream simulated on its own, including start-of-data starts after newlines and streams continued over several calls.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    // "abc" anywhere, "xy" at the start of a line
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *c = new STE("c", "[c]", "none");
+    STE *x = new STE("x", "[x]", "start-of-data");
+    STE *y = new STE("y", "[y]", "none");
+    c->setReporting(true);
+    y->setReporting(true);
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(c);
+    ap.rawAddSTE(x);
+    ap.rawAddSTE(y);
+    ap.addEdge(a, b);
+    ap.addEdge(b, c);
+    ap.addEdge(x, y);
+    ap.setQuiet(true);
+    ap.setReport(true);
+
+    const uint32_t num_streams = 5;
+    vector<string> inputs(num_streams);
+    vector<vector<pair<uint64_t, string>>> expected(num_streams);
+    for(uint32_t s = 0; s < num_streams; s++) {
+        for(uint32_t i = 0; i < 20 * (s + 1); i++)
+            inputs[s] += (i % (s + 2) == 0) ? "xy\n" : "zabc";
+
+        SimulationContext *ctx = ap.newSimulationContext();
+        ap.simulate(*ctx, (uint8_t*)inputs[s].c_str(), 0, inputs[s].size(), inputs[s].size());
+        expected[s] = ctx->getReportVector();
+        delete ctx;
+    }
+    assert(!expected[0].empty(), testname, "1");
+
+    // all streams at once
+    SimulationContext *ctxs[num_streams];
+    uint8_t *data[num_streams];
+    uint64_t lengths[num_streams];
+    bool ends[num_streams];
+    for(uint32_t s = 0; s < num_streams; s++) {
+        ctxs[s] = ap.newSimulationContext();
+        ap.initializeSimulation(*ctxs[s], true);
+        data[s] = (uint8_t*)inputs[s].c_str();
+        lengths[s] = inputs[s].size();
+        ends[s] = true;
+    }
+
+    ap.simulateInterleaved(ctxs, data, lengths, ends, num_streams);
+    for(uint32_t s = 0; s < num_streams; s++) {
+        assert(ctxs[s]->getReportVector() == expected[s], testname, "2");
+        assert(ctxs[s]->getCycle() == inputs[s].size(), testname, "3");
+    }
+
+    // the same streams continued in pieces of 7 symbols; short streams drop out
+    SimulationContext *all[num_streams];
+    for(uint32_t s = 0; s < num_streams; s++) {
+        all[s] = ctxs[s];
+        all[s]->reset();
+        ap.initializeSimulation(*all[s], true);
+    }
+
+    for(uint64_t start = 0; start < inputs[num_streams - 1].size(); start += 7) {
+        uint32_t n = 0;
+        for(uint32_t s = 0; s < num_streams; s++) {
+            if(start >= inputs[s].size())
+                continue;
+            ctxs[n] = all[s];
+            data[n] = (uint8_t*)inputs[s].c_str() + start;
+            lengths[n] = min((uint64_t)7, inputs[s].size() - start);
+            ends[n] = (start + lengths[n] == inputs[s].size());
+            n++;
+        }
+        ap.simulateInterleaved(ctxs, data, lengths, ends, n);
+    }
+
+    for(uint32_t s = 0; s < num_streams; s++)
+        assert(all[s]->getReportVector() == expected[s], testname, "4");
+
+    for(uint32_t s = 0; s < num_streams; s++)
+        delete all[s];
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
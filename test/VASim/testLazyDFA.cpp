@@ -0,0 +1,64 @@
+#include "automata.h"
+#include "test.h"
+#include "reportFixture.h"
+
+using namespace std;
+
+string testname = "TEST_LAZY_DFA";
+
+/**
+ * TEST DESCRIPTION: the lazy DFA engine should produce the same reports in the same cycles as the default engine, with the reports of one cycle in compiled STE index order, both with a warm cache and when the cache is too small to hold more than a few states, and none when reporting is disabled.
+ */
+int main(int argc, char * argv[]) {
+
+    uint8_t *input = (uint8_t*)reportFixtureInput.c_str();
+    uint64_t size = reportFixtureInput.size();
+
+    Automata dfa;
+    Automata small;
+    buildReportFixture(dfa);
+    buildReportFixture(small);
+    small.setLazyDFACacheSize(1);
+
+    small.simulateLazyDFA(input, 0, size, size);
+
+    // simulate twice so the second run hits the warm cache
+    dfa.simulateLazyDFA(input, 0, size, size);
+    dfa.reset();
+    dfa.simulateLazyDFA(input, 0, size, size);
+
+    vector<pair<uint64_t, string>> result = dfa.getReportVector();
+    vector<pair<uint64_t, string>> result_small = small.getReportVector();
+
+    assert(dfa.getLazyDFAEngine()->getHits() > 0, testname, "no cache hits");
+    assert(small.getLazyDFAEngine()->getFlushes() > 0, testname, "no cache flushes");
+
+    assert(result == reportFixtureReports, testname, "report mismatch");
+    assert(result_small == reportFixtureReports, testname, "report mismatch after flush");
+
+    // reports of one cycle are sent in compiled STE index order
+    Automata nfa;
+    Automata fan;
+    buildFanOutFixture(nfa);
+    buildFanOutFixture(fan);
+
+    uint8_t *fanInput = (uint8_t*)fanOutInput.c_str();
+    uint64_t fanSize = fanOutInput.size();
+    nfa.simulate(fanInput, 0, fanSize, fanSize);
+    fan.simulateLazyDFA(fanInput, 0, fanSize, fanSize);
+
+    vector<pair<uint64_t, string>> expected = inCompiledOrder(nfa, nfa.getReportVector());
+    assert(expected != nfa.getReportVector(), testname, "fan-out fixture already in index order");
+    assert(fan.getReportVector() == expected, testname, "same-cycle report order");
+
+    // without reporting, the engine must not collect reports
+    Automata silent;
+    buildReportFixture(silent);
+    silent.setReport(false);
+    silent.simulateLazyDFA(input, 0, size, size);
+
+    assert(silent.getReportVector().size() == 0, testname, "reports collected without reporting");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
@@ -0,0 +1,76 @@
+#include "automata.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_MERGE_SIGNATURES";
+
+/**
+ * TEST DESCRIPTION: left and right identical STEs should have equal signatures, and prefix, suffix and common path merging should shrink the automata without changing its reports.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    // "abc" and "abd" share the prefix "ab"; "xc"/"yc" share the suffix, "x" and "y" a path
+    vector<STE *> stes;
+    auto add = [&](string id, string symbols, string start) {
+        STE *ste = new STE(id, symbols, start);
+        ap.rawAddSTE(ste);
+        stes.push_back(ste);
+        return ste;
+    };
+
+    STE *a1 = add("a1", "[a]", "all-input");
+    STE *b1 = add("b1", "[b]", "none");
+    STE *c1 = add("c1", "[c]", "none");
+    STE *a2 = add("a2", "[a]", "all-input");
+    STE *b2 = add("b2", "[b]", "none");
+    STE *d2 = add("d2", "[d]", "none");
+    STE *s = add("s", "[s]", "all-input");
+    STE *x = add("x", "[x]", "none");
+    STE *y = add("y", "[y]", "none");
+    STE *e = add("e", "[e]", "none");
+    c1->setReporting(true);
+    d2->setReporting(true);
+    e->setReporting(true);
+
+    ap.addEdge(a1, b1);
+    ap.addEdge(b1, c1);
+    ap.addEdge(a2, b2);
+    ap.addEdge(b2, d2);
+    ap.addEdge(s, x);
+    ap.addEdge(s, y);
+    ap.addEdge(x, e);
+    ap.addEdge(y, e);
+
+    // identical prefixes hash alike, different ones do not
+    assert(a1->leftSignature() == a2->leftSignature(), testname, "1");
+    assert(a1->leftSignature() != s->leftSignature(), testname, "2");
+    assert(b1->rightSignature() != b2->rightSignature(), testname, "3");
+    assert(x->pathSignature() == y->pathSignature(), testname, "4");
+
+    ap.setQuiet(true);
+    ap.setReport(true);
+
+    string input = "abcabdsxesyeabdsxe";
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    vector<pair<uint64_t, string>> expected = ap.getReportVector();
+
+    // a2 and b2 merge into a1 and b1
+    assert(ap.mergeCommonPrefixes() == 2, testname, "5");
+
+    // x and y merge into one STE matching [xy]
+    assert(ap.mergeCommonPaths() == 1, testname, "6");
+    assert(ap.getElements().size() == 7, testname, "7");
+
+    ap.validate();
+    assert(ap.getErrorCode() == E_SUCCESS, testname, "8");
+
+    ap.reset();
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    assert(ap.getReportVector() == expected, testname, "9");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
@@ -0,0 +1,56 @@
+#include "automata.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_REPORT_ORDER";
+
+/**
+ * TEST DESCRIPTION: reports within a cycle should come out in the same order as when all-input start states were pushed onto the enabled stack every cycle: start states last enabled first, then children of the last cycle's activations in reverse order. All-input starts that were also enabled by a parent keep the parent's place.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    STE *a1 = new STE("a1", "[a]", "all-input");
+    STE *s1 = new STE("s1", "[a]", "start-of-data");
+    STE *x = new STE("x", "[x]", "all-input");
+    STE *a2 = new STE("a2", "[a]", "all-input");
+    STE *c1 = new STE("c1", "[a]", "none");
+    STE *c2 = new STE("c2", "[a]", "none");
+    a1->setReporting(true);
+    s1->setReporting(true);
+    a2->setReporting(true);
+    c1->setReporting(true);
+    c2->setReporting(true);
+
+    ap.rawAddSTE(a1);
+    ap.rawAddSTE(s1);
+    ap.rawAddSTE(x);
+    ap.rawAddSTE(a2);
+    ap.rawAddSTE(c1);
+    ap.rawAddSTE(c2);
+
+    // a2 is an all-input start that x enables as well
+    ap.addEdge(x, c1);
+    ap.addEdge(x, a2);
+    ap.addEdge(x, c2);
+
+    ap.setQuiet(true);
+    ap.setReport(true);
+
+    string input = "axa\naxa";
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+
+    vector<pair<uint64_t, string>> expected = {
+        {0, "s1"}, {0, "a2"}, {0, "a1"},
+        {2, "a1"}, {2, "c2"}, {2, "a2"}, {2, "c1"},
+        {4, "s1"}, {4, "a2"}, {4, "a1"},
+        {6, "a1"}, {6, "c2"}, {6, "a2"}, {6, "c1"}
+    };
+
+    assert(ap.getReportVector() == expected, testname, "report order");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
@@ -0,0 +1,137 @@
+#include "automata.h"
+#include "test.h"
+
+#include <thread>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+string testname = "TEST_REPORT_SINK";
+
+/*
+ * Reads a whole file into a string.
+ */
+string readFile(string fn) {
+
+    ifstream in(fn, ios::binary);
+    stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+/**
+ * TEST DESCRIPTION: reports sent to a callback, counting or ring buffer sink should carry compiled ids that resolve to the same element ids and report codes as the default report vector. Collected reports should still resolve to the right ids and codes after the graph is edited and recompiled.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *c = new STE("c", "[bc]", "all-input");
+    b->setReporting(true);
+    b->setReportCode("7");
+    c->setReporting(true);
+
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(c);
+    ap.addEdge(a, b);
+
+    ap.setQuiet(true);
+    ap.setReport(true);
+
+    string input = "abcxabcc";
+
+    // reference run in the default sink
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    vector<pair<uint64_t, string>> expected = ap.getReportVector();
+    assert(expected.size() == 7, testname, "1");
+
+    CompiledAutomata *compiled = ap.getCompiledAutomata();
+
+    // callback sink
+    SimulationContext *ctx = ap.newSimulationContext();
+    vector<pair<uint64_t, string>> seen;
+    vector<uint32_t> ids;
+    CallbackReportSink callback([&](uint64_t cycle, uint32_t element) {
+            seen.push_back(make_pair(cycle, compiled->getReportId(element)));
+            ids.push_back(element);
+        });
+    ctx->setReportSink(&callback);
+    ap.simulate(*ctx, (uint8_t*)input.c_str(), 0, input.size(), input.size());
+    assert(seen == expected, testname, "2");
+
+    // reports sent elsewhere are not collected in the context
+    assert(ctx->getReports().empty(), testname, "3");
+
+    // report codes resolve through the same table
+    bool codes = true;
+    for(uint32_t id : ids) {
+        codes &= (compiled->getReportCode(id) == ap.getElement(compiled->getReportId(id))->getReportCode());
+        codes &= (compiled->getReportCode(id) == (compiled->getElement(id) == b ? "7" : ""));
+    }
+    assert(codes, testname, "4");
+
+    // counting sink; b and c both report on cycles 1 and 5
+    CountingReportSink counting;
+    ctx->reset();
+    ctx->setReportSink(&counting);
+    ap.simulate(*ctx, (uint8_t*)input.c_str(), 0, input.size(), input.size());
+    assert(counting.getNumReports() == 7, testname, "5");
+    assert(counting.getNumReportingCycles() == 5, testname, "6");
+
+    // a ring buffer smaller than the run, drained by another thread
+    RingBufferReportSink ring(2);
+    vector<pair<uint64_t, string>> drained;
+    ctx->reset();
+    ctx->setReportSink(&ring);
+    thread consumer([&]() {
+            Report r;
+            while(drained.size() < expected.size()) {
+                if(ring.pop(r))
+                    drained.push_back(make_pair(r.cycle, compiled->getReportId(r.element)));
+            }
+        });
+    ap.simulate(*ctx, (uint8_t*)input.c_str(), 0, input.size(), input.size());
+    consumer.join();
+    assert(ring.getCapacity() == 2, testname, "7");
+    assert(drained == expected, testname, "8");
+
+    // restoring the default sink collects reports in the context again
+    ctx->reset();
+    ctx->setReportSink(NULL);
+    ap.simulate(*ctx, (uint8_t*)input.c_str(), 0, input.size(), input.size());
+    assert(ctx->getReportVector() == expected, testname, "9");
+
+    string written;
+    for(auto &r : expected) {
+        written += to_string(r.first) + " : " + r.second + " : " + (r.second == "b" ? "7" : "") + "\n";
+    }
+
+    // edit and recompile the graph; both contexts still hold reports of the old one
+    STE *d = new STE("d", "[d]", "all-input");
+    d->setReporting(true);
+    d->setReportCode("9");
+    ap.rawAddSTE(d);
+    ap.addEdge(d, a);
+    ap.getCompiledAutomata();
+
+    ap.writeReportToFile(*ctx, "testReportSinkContext.txt");
+    assert(readFile("testReportSinkContext.txt") == written, testname, "10");
+
+    ap.writeReportToFile("testReportSink.txt");
+    assert(readFile("testReportSink.txt") == written, testname, "11");
+
+    // reports of the new graph are added to the old ones
+    string more = "d";
+    ap.simulate((uint8_t*)more.c_str(), 0, more.size(), more.size());
+    ap.writeReportToFile("testReportSink.txt");
+    assert(readFile("testReportSink.txt") == written + "0 : d : 9\n", testname, "12");
+
+    delete ctx;
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
@@ -0,0 +1,171 @@
+#include "automata.h"
+#include "reportWriter.h"
+#include "test.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+string testname = "TEST_REPORT_WRITER";
+
+/*
+ * Reads a whole file into a string.
+ */
+string readFile(string fn) {
+
+    ifstream in(fn, ios::binary);
+    stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+/**
+ * TEST DESCRIPTION: report files written by the writer thread while simulating should contain the same reports as files written after simulation, even if the report ring and output buffers are much smaller than the number of reports. Reports of concurrently simulated automata merged into one file should be ordered by cycle.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *c = new STE("c", "[bc]", "all-input");
+    b->setReporting(true);
+    b->setReportCode("7");
+    c->setReporting(true);
+
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(c);
+    ap.addEdge(a, b);
+
+    ap.setQuiet(true);
+    ap.setReport(true);
+
+    string input;
+    for(uint32_t i = 0; i < 100; i++)
+        input += "abcxabcc";
+
+    // reference run, written after simulation
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    vector<pair<uint64_t, string>> expected = ap.getReportVector();
+    ap.writeReportToFile("testReportWriterExpected.txt");
+    assert(expected.size() == 700, testname, "1");
+
+    // text and binary streams from two contexts, with tiny rings and buffers
+    CompiledAutomata *compiled = ap.getCompiledAutomata();
+    SimulationContext *text_ctx = ap.newSimulationContext();
+    SimulationContext *binary_ctx = ap.newSimulationContext();
+
+    ReportWriter text_writer(REPORT_FORMAT_TEXT, 4, 16);
+    ReportWriter binary_writer(REPORT_FORMAT_BINARY, 4, 16);
+    text_ctx->setReportSink(text_writer.addStream("testReportWriter.txt", compiled));
+    binary_ctx->setReportSink(binary_writer.addStream("testReportWriter.vrb", compiled));
+    text_writer.start();
+    binary_writer.start();
+
+    ap.simulate(*text_ctx, (uint8_t*)input.c_str(), 0, input.size(), input.size());
+    ap.simulate(*binary_ctx, (uint8_t*)input.c_str(), 0, input.size(), input.size());
+
+    text_writer.finish();
+    binary_writer.finish();
+
+    // nothing is kept in memory
+    assert(text_ctx->getReports().empty() && binary_ctx->getReports().empty(), testname, "2");
+
+    // statistics
+    assert(text_writer.getNumReports(0) == 700, testname, "3");
+    assert(text_writer.getNumReportingCycles(0) == 500, testname, "4");
+    assert(binary_writer.getNumReports(0) == 700, testname, "5");
+
+    // text file is identical to the one written after simulation
+    string text = readFile("testReportWriter.txt");
+    assert(text.size() > 0 && text == readFile("testReportWriterExpected.txt"), testname, "6");
+
+    // binary file header
+    string binary = readFile("testReportWriter.vrb");
+    BinaryReportHeader header;
+    assert(binary.size() >= sizeof(BinaryReportHeader), testname, "7");
+    memcpy(&header, binary.data(), sizeof(BinaryReportHeader));
+    assert(memcmp(header.magic, BINARY_REPORT_MAGIC, sizeof(header.magic)) == 0, testname, "8");
+    assert(header.num_elements == compiled->getNumElements(), testname, "9");
+    assert(header.records_offset % 8 == 0, testname, "10");
+    assert((binary.size() - header.records_offset) == 700 * BINARY_REPORT_RECORD_SIZE, testname, "11");
+
+    // binary records resolve through the element table to the expected reports
+    const BinaryReportElement *table = (const BinaryReportElement *)(binary.data() + sizeof(BinaryReportHeader));
+    const char *pool = binary.data() + header.strings_offset;
+    vector<pair<uint64_t, string>> seen;
+    for(uint64_t offset = header.records_offset; offset < binary.size(); offset += BINARY_REPORT_RECORD_SIZE) {
+        uint64_t cycle;
+        uint32_t element;
+        memcpy(&cycle, binary.data() + offset, sizeof(uint64_t));
+        memcpy(&element, binary.data() + offset + sizeof(uint64_t), sizeof(uint32_t));
+        assert(element < header.num_elements, testname, "12");
+        seen.push_back(make_pair(cycle, string(pool + table[element].id_offset, table[element].id_length)));
+
+        string code(pool + table[element].report_code_offset, table[element].report_code_length);
+        assert(code == compiled->getReportCode(element), testname, "13");
+    }
+    assert(seen == expected, testname, "14");
+
+    delete text_ctx;
+    delete binary_ctx;
+
+    // two automata simulated concurrently into one merged output
+    Automata other;
+    STE *x = new STE("x", "[x]", "all-input");
+    STE *c2 = new STE("c2", "[c]", "all-input");
+    x->setReporting(true);
+    c2->setReporting(true);
+    c2->setReportCode("9");
+    other.rawAddSTE(x);
+    other.rawAddSTE(c2);
+    other.setQuiet(true);
+    other.setReport(true);
+
+    ReportWriter merged_writer(REPORT_FORMAT_TEXT, 4, 16);
+    uint32_t output = merged_writer.addOutput("testReportWriterMerged.txt");
+    ap.getSimulationContext().setReportSink(merged_writer.addStream(output, ap.getCompiledAutomata()));
+    other.getSimulationContext().setReportSink(merged_writer.addStream(output, other.getCompiledAutomata()));
+    merged_writer.start();
+
+    ap.getSimulationContext().reset();
+    thread t([&]() {
+            other.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+        });
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    t.join();
+    merged_writer.finish();
+
+    ap.getSimulationContext().setReportSink(NULL);
+    other.getSimulationContext().setReportSink(NULL);
+
+    // expected order: by cycle, and by stream within a cycle
+    other.getSimulationContext().reset();
+    other.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    vector<pair<uint64_t, string>> other_expected = other.getReportVector();
+
+    string merged;
+    auto i1 = expected.begin();
+    auto i2 = other_expected.begin();
+    while(i1 != expected.end() || i2 != other_expected.end()) {
+        if(i2 == other_expected.end() || (i1 != expected.end() && i1->first <= i2->first)) {
+            merged += to_string(i1->first) + " : " + i1->second + " : " + ap.getElement(i1->second)->getReportCode() + "\n";
+            i1++;
+        }else{
+            merged += to_string(i2->first) + " : " + i2->second + " : " + other.getElement(i2->second)->getReportCode() + "\n";
+            i2++;
+        }
+    }
+
+    assert(merged_writer.getNumOutputs() == 1 && merged_writer.getNumStreams() == 2, testname, "15");
+    assert(merged_writer.getNumReports(0) == 1100, testname, "16");
+    assert(merged_writer.getNumReportingCycles(0) == 600, testname, "17");
+    assert(readFile("testReportWriterMerged.txt") == merged, testname, "18");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
@@ -0,0 +1,117 @@
+#include "automata.h"
+#include "test.h"
+
+#include <thread>
+
+using namespace std;
+
+string testname = "TEST_SIMULATION_CONTEXT";
+
+/*
+ * Simulates input in a context.
+ */
+void simulateContext(Automata *ap, SimulationContext *ctx, string *input) {
+
+    ap->simulate(*ctx, (uint8_t*)input->c_str(), 0, input->size(), input->size());
+}
+
+/**
+ * TEST DESCRIPTION: several simulation contexts sharing one automata, run concurrently, should each produce the same reports as the automata's own context, including automata whose counters keep state across cycles.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *c = new STE("c", "[c]", "start-of-data");
+    b->setReporting(true);
+    c->setReporting(true);
+
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(c);
+    ap.addEdge(a, b);
+
+    ap.setQuiet(true);
+    ap.setReport(true);
+
+    string input1 = "cabxab\ncab";
+    string input2 = "xxab\nab";
+
+    // reference runs in the automata's own context
+    ap.simulate((uint8_t*)input1.c_str(), 0, input1.size(), input1.size());
+    vector<pair<uint64_t, string>> expected1 = ap.getReportVector();
+    assert(expected1.size() == 5, testname, "1");
+
+    ap.reset();
+    ap.simulate((uint8_t*)input2.c_str(), 0, input2.size(), input2.size());
+    vector<pair<uint64_t, string>> expected2 = ap.getReportVector();
+    assert(expected2.size() == 2, testname, "2");
+
+    // concurrent runs in separate contexts
+    SimulationContext *ctx1 = ap.newSimulationContext();
+    SimulationContext *ctx2 = ap.newSimulationContext();
+
+    thread t1(simulateContext, &ap, ctx1, &input1);
+    thread t2(simulateContext, &ap, ctx2, &input2);
+    t1.join();
+    t2.join();
+
+    assert(ctx1->getReportVector() == expected1, testname, "3");
+    assert(ctx2->getReportVector() == expected2, testname, "4");
+
+    // a reset context can be reused for another stream
+    ctx1->reset();
+    simulateContext(&ap, ctx1, &input2);
+    assert(ctx1->getReportVector() == expected2, testname, "5");
+
+    delete ctx1;
+    delete ctx2;
+
+    // counter values are kept per context
+    Automata cp;
+
+    STE *x = new STE("x", "[a]", "all-input");
+    STE *r = new STE("r", "[r]", "all-input");
+    Counter *counter = new Counter("counter", 3, "pulse");
+    counter->setReporting(true);
+
+    cp.rawAddSTE(x);
+    cp.rawAddSTE(r);
+    cp.rawAddSpecialElement(counter);
+    cp.addEdge("x", "counter:cnt");
+    cp.addEdge("r", "counter:rst");
+
+    cp.setQuiet(true);
+    cp.setReport(true);
+
+    string input3 = "aaaraaaa";
+    string input4 = "aaaaaaaa";
+
+    cp.simulate((uint8_t*)input3.c_str(), 0, input3.size(), input3.size());
+    vector<pair<uint64_t, string>> expected3 = cp.getReportVector();
+    assert(expected3.size() == 2, testname, "6");
+
+    cp.reset();
+    cp.simulate((uint8_t*)input4.c_str(), 0, input4.size(), input4.size());
+    vector<pair<uint64_t, string>> expected4 = cp.getReportVector();
+    assert(expected4.size() == 1, testname, "7");
+
+    ctx1 = cp.newSimulationContext();
+    ctx2 = cp.newSimulationContext();
+
+    thread t3(simulateContext, &cp, ctx1, &input3);
+    thread t4(simulateContext, &cp, ctx2, &input4);
+    t3.join();
+    t4.join();
+
+    assert(ctx1->getReportVector() == expected3, testname, "8");
+    assert(ctx2->getReportVector() == expected4, testname, "9");
+
+    delete ctx1;
+    delete ctx2;
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
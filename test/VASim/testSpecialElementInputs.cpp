@@ -0,0 +1,85 @@
+#include "automata.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_SPECIAL_ELEMENT_INPUTS";
+
+/**
+ * TEST DESCRIPTION: special element inputs raised by index in the simulation context should give the same gate and counter results as the named inputs, including counter ports and inputs raised by injected elements.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "all-input");
+    STE *r = new STE("r", "[r]", "all-input");
+
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(r);
+
+    OR *orgate = new OR("or");
+    NOR *norgate = new NOR("nor");
+    Inverter *inverter = new Inverter("inv");
+    Counter *counter = new Counter("counter", 2, "latch");
+    orgate->setReporting(true);
+    norgate->setReporting(true);
+    inverter->setReporting(true);
+    counter->setReporting(true);
+
+    ap.rawAddSpecialElement(orgate);
+    ap.rawAddSpecialElement(norgate);
+    ap.rawAddSpecialElement(inverter);
+    ap.rawAddSpecialElement(counter);
+
+    ap.addEdge("a", "or");
+    ap.addEdge("b", "or");
+    ap.addEdge("a", "nor");
+    ap.addEdge("b", "nor");
+    ap.addEdge("a", "inv");
+    ap.addEdge("a", "counter:cnt");
+    ap.addEdge("r", "counter:rst");
+
+    ap.setReport(true);
+    ap.initializeSimulation();
+
+    // inputs are counted per port
+    assert(orgate->getNumInputs() == 2, testname, "1");
+    assert(counter->getNumInputs() == 2, testname, "2");
+    assert(counter->getNumInputs(PORT_CNT) == 1 && counter->getNumInputs(PORT_RST) == 1, testname, "3");
+
+    // "x" enables nothing: nor and inverter report
+    ap.simulate('x');
+    assert(ap.getReportVector().size() == 2, testname, "4");
+
+    // "a" raises or and the counter
+    ap.simulate('a');
+    assert(ap.getReportVector().size() == 3, testname, "5");
+
+    // second "a" reaches the counter target; the counter latches
+    ap.simulate('a');
+    assert(ap.getReportVector().size() == 5, testname, "6");
+
+    ap.simulate('b');
+    assert(ap.getReportVector().size() == 8, testname, "7");
+
+    // reset clears the latched counter
+    ap.simulate('r');
+    assert(ap.getReportVector().size() == 10, testname, "8");
+
+    // an injected "a" raises or and counts once; nor and inverter stay low
+    vector<string> injects = {"a"};
+    ap.simulate('x', injects);
+    assert(ap.getReportVector().size() == 11, testname, "9");
+
+    // the counter reaches its target with the injected and the matching "a"
+    ap.simulate('a', injects);
+    assert(ap.getReportVector().size() == 13, testname, "10");
+    vector<pair<uint64_t, string>> &reports = ap.getReportVector();
+    assert(reports[11].second == "counter" || reports[12].second == "counter", testname, "11");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
@@ -0,0 +1,87 @@
+#include "automata.h"
+#include "streamScanner.h"
+#include "test.h"
+
+using namespace std;
+
+string testname = "TEST_STREAM_SCANNER";
+
+/**
+ * TEST DESCRIPTION: streams scanned piece by piece, alone or in concurrent batches, should report exactly like a single run over each stream, and reused or reset streams should start over.
+ */
+int main(int argc, char * argv[]) {
+
+    Automata ap;
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *c = new STE("c", "[c]", "none");
+    c->setReporting(true);
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(c);
+    ap.addEdge(a, b);
+    ap.addEdge(b, c);
+    ap.setQuiet(true);
+    ap.setReport(true);
+
+    // every stream holds a different number of matches
+    const uint32_t num_streams = 8;
+    vector<string> inputs(num_streams);
+    vector<vector<pair<uint64_t, string>>> expected(num_streams);
+    for(uint32_t s = 0; s < num_streams; s++) {
+        for(uint32_t i = 0; i < 50; i++)
+            inputs[s] += (i % (s + 1) == 0) ? "abc" : "xbx";
+
+        SimulationContext *ctx = ap.newSimulationContext();
+        ap.simulate(*ctx, (uint8_t*)inputs[s].c_str(), 0, inputs[s].size(), inputs[s].size());
+        expected[s] = ctx->getReportVector();
+        delete ctx;
+    }
+
+    StreamScanner scanner(&ap);
+    assert(scanner.getNumOpenStreams() == 0, testname, "1");
+
+    vector<StreamHandle> handles;
+    for(uint32_t s = 0; s < num_streams; s++)
+        handles.push_back(scanner.open());
+    assert(scanner.getNumOpenStreams() == num_streams, testname, "2");
+
+    // pieces of 4 symbols split the matches, interleaved across streams
+    vector<StreamBlock> blocks;
+    for(uint64_t start = 0; start < inputs[0].size(); start += 4) {
+        for(uint32_t s = 0; s < num_streams; s++) {
+            uint64_t length = min((uint64_t)4, inputs[s].size() - start);
+            StreamBlock block = {handles[s], (uint8_t*)inputs[s].c_str() + start, length, start + length == inputs[s].size()};
+            blocks.push_back(block);
+        }
+    }
+
+    scanner.scan(blocks, 4);
+    for(uint32_t s = 0; s < num_streams; s++)
+        assert(scanner.getContext(handles[s]).getReportVector() == expected[s], testname, "3");
+
+    // a reset stream starts over at cycle 0
+    scanner.reset(handles[0]);
+    assert(scanner.getReports(handles[0]).empty(), testname, "4");
+    scanner.scan(handles[0], (uint8_t*)inputs[0].c_str(), 10, false);
+    scanner.scan(handles[0], (uint8_t*)inputs[0].c_str() + 10, inputs[0].size() - 10, true);
+    assert(scanner.getContext(handles[0]).getReportVector() == expected[0], testname, "5");
+
+    // a closed handle is reused by the next stream, which starts empty
+    scanner.close(handles[3]);
+    assert(scanner.getNumOpenStreams() == num_streams - 1, testname, "6");
+    StreamHandle reused = scanner.open();
+    assert(reused == handles[3], testname, "7");
+    assert(scanner.getReports(reused).empty(), testname, "8");
+    assert(scanner.getContext(reused).getCycle() == 0, testname, "9");
+
+    // reports can go to a sink of their own
+    CountingReportSink counter;
+    StreamHandle counted = scanner.open(&counter);
+    scanner.scan(counted, (uint8_t*)inputs[1].c_str(), inputs[1].size(), true);
+    assert(counter.getNumReports() == expected[1].size(), testname, "10");
+    assert(scanner.getReports(counted).empty(), testname, "11");
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}
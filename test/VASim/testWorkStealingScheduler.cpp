@@ -0,0 +1,97 @@
+#include "automata.h"
+#include "workStealingScheduler.h"
+#include "test.h"
+
+#include <mutex>
+
+using namespace std;
+
+string testname = "TEST_WORK_STEALING_SCHEDULER";
+
+/**
+ * TEST DESCRIPTION: every task and every task it spawns should run exactly once, chains of spawned tasks should run in order, and an input scanned in blocks by chained tasks should report exactly like a single sequential run.
+ */
+int main(int argc, char * argv[]) {
+
+    // 16 chains of 100 links each on 4 workers
+    WorkStealingScheduler scheduler(4);
+    assert(scheduler.getNumWorkers() == 4, testname, "1");
+
+    const uint32_t num_chains = 16;
+    const uint32_t length = 100;
+    vector<vector<uint32_t>> links(num_chains);
+    mutex lock;
+
+    function<SchedulerTask(uint32_t, uint32_t)> link = [&](uint32_t chain, uint32_t i) -> SchedulerTask {
+        return [&, chain, i](WorkStealingScheduler &s, uint32_t worker) {
+            {
+                lock_guard<mutex> guard(lock);
+                links[chain].push_back(i);
+            }
+            if(i + 1 < length)
+                s.spawn(worker, link(chain, i + 1));
+        };
+    };
+
+    for(uint32_t chain = 0; chain < num_chains; chain++)
+        scheduler.push(link(chain, 0));
+
+    scheduler.run();
+
+    for(uint32_t chain = 0; chain < num_chains; chain++) {
+        assert(links[chain].size() == length, testname, "2");
+        for(uint32_t i = 0; i < links[chain].size(); i++)
+            assert(links[chain][i] == i, testname, "3");
+    }
+
+    // a scheduler without tasks returns right away
+    WorkStealingScheduler empty(2);
+    empty.run();
+    assert(empty.getNumSteals() == 0, testname, "4");
+
+    // scanning in blocks keeps the state across block boundaries
+    Automata ap;
+    STE *a = new STE("a", "[a]", "all-input");
+    STE *b = new STE("b", "[b]", "none");
+    STE *c = new STE("c", "[c]", "none");
+    c->setReporting(true);
+    ap.rawAddSTE(a);
+    ap.rawAddSTE(b);
+    ap.rawAddSTE(c);
+    ap.addEdge(a, b);
+    ap.addEdge(b, c);
+    ap.setQuiet(true);
+    ap.setReport(true);
+
+    string input;
+    for(uint32_t i = 0; i < 1000; i++)
+        input += "xabc";
+
+    ap.simulate((uint8_t*)input.c_str(), 0, input.size(), input.size());
+    vector<pair<uint64_t, string>> expected = ap.getReportVector();
+    assert(expected.size() == 1000, testname, "5");
+
+    // blocks of 3 symbols split every match
+    SimulationContext *ctx = ap.newSimulationContext();
+    const uint64_t block = 3;
+    function<SchedulerTask(uint64_t)> scan = [&](uint64_t start) -> SchedulerTask {
+        return [&, start](WorkStealingScheduler &s, uint32_t worker) {
+            uint64_t len = min(block, input.size() - start);
+            if(start == 0)
+                ap.initializeSimulation(*ctx, true);
+            ap.simulateChunk(*ctx, (uint8_t*)input.c_str() + start, len, start + len == input.size());
+            if(start + len < input.size())
+                s.spawn(worker, scan(start + len));
+        };
+    };
+
+    WorkStealingScheduler scanner(3);
+    scanner.push(scan(0));
+    scanner.run();
+
+    assert(ctx->getReportVector() == expected, testname, "6");
+    delete ctx;
+
+    // if we haven't failed, pass the test
+    pass(testname);
+}